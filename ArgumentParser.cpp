@@ -6,10 +6,12 @@
 Option::Option(
     std::optional<char> shortName,
     std::optional<std::string> longName,
-    Argument argument
+    Argument argument,
+    std::string description
 )
 :   shortName{shortName},
     longName{longName},
+    description{std::move(description)},
     argument{std::move(argument)} {}
 
 
@@ -40,9 +42,10 @@ ArgumentParser& ArgumentParser::addOpt(Option argument) {
 ArgumentParser& ArgumentParser::addOpt(
     std::optional<char> shortName,
     std::optional<std::string> longName,
-    Argument argument
+    Argument argument,
+    std::string description
 ) {
-    return this->addOpt({shortName, longName, argument});
+    return this->addOpt({shortName, longName, argument, description});
 }
 
 ArgumentParser& ArgumentParser::setDefaultArg(VariableArgument arg) {
@@ -64,7 +67,8 @@ bool ArgumentParser::parseValue(const char* opt) {
 bool ArgumentParser::handleOption(
     const Option* option,
     const std::string& optionName,
-    bool supportsArg
+    bool supportsArg,
+    const char* value
 ) {
     if (!option) {
         this->errorStream 
@@ -78,10 +82,10 @@ bool ArgumentParser::handleOption(
     }
 
     if (std::holds_alternative<VariableArgument>(option->argument)) {
-        auto next = this->getNextCstr();
+        auto next = value ? value : this->getNextCstr();
         if (!next 
             || !supportsArg
-            || (std::strlen(next) > 0 && next[0] == '-')
+            || (!value && std::strlen(next) > 0 && next[0] == '-')
         ) {
             this->errorStream 
                 << std::format("{}: missing argument to option '{}'\n",
@@ -103,6 +107,13 @@ bool ArgumentParser::handleOption(
             );
             return false;
         }
+    } else if (value) {
+        this->errorStream
+            << std::format("{}: option '{}' doesn't allow an argument\n",
+                this->programName,
+                optionName
+            );
+        return false;
     } else {
         std::get<UnitArgument>(option->argument)();
     }
@@ -133,6 +144,19 @@ bool ArgumentParser::parseLong(std::string_view opt) {
         this->doneHandling = true;
         return true;
     }
+
+    // The value of --name=value follows the '=' in the same argument, which
+    // is null terminated like the view.
+    auto equals = opt.find('=');
+    if (equals != std::string_view::npos) {
+        auto name = opt.substr(0, equals);
+        return this->handleOption(
+            this->getOption(name),
+            std::format("--{}", name),
+            true,
+            opt.data() + equals + 1
+        );
+    }
     return this->handleOption(this->getOption(opt), std::format("--{}", opt), true);
 }
 
@@ -199,6 +223,10 @@ void ArgumentParser::printHelp(std::ostream& stream) {
             stream << "  <arg>";
         }
         stream << '\n';
+
+        if (!option.description.empty()) {
+            stream << "        " << option.description << '\n';
+        }
     }
 }
 
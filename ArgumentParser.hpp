@@ -27,7 +27,8 @@ public:
     Option(
         std::optional<char> shortName,
         std::optional<std::string> longName,
-        Argument argument
+        Argument argument,
+        std::string description = ""
     );
 };
 
@@ -52,7 +53,8 @@ private:
     bool handleOption(
         const Option* option,
         const std::string& optionName,
-        bool supportsArg = true
+        bool supportsArg = true,
+        const char* value = nullptr
     );
 
     const Option* getOption(char name);
@@ -63,7 +65,8 @@ public:
     ArgumentParser& addOpt(
         std::optional<char> shortName,
         std::optional<std::string> longName,
-        Argument argument
+        Argument argument,
+        std::string description = ""
     );
     ArgumentParser& setDefaultArg(VariableArgument arg);
     bool parse();
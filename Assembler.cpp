@@ -1,7 +1,6 @@
 #include "Assembler.hpp"
 #include "Error.hpp"
 #include "Context.hpp"
-#include "Driver.hpp"
 #include <algorithm>
 #include <iostream>
 #include <sstream>
@@ -14,17 +13,31 @@
 
 Assembler::Assembler(
     SectionMode sectionMode,
-    const std::span<std::string_view> includePath,
+    const InstructionSet& instructionSet,
+    ParseCache& parseCache,
     std::optional<std::string> prelude
 )
 :   symbols{},
-    parsedFiles{},
-    includePath{includePath},
+    definitions{},
     sectionMode{sectionMode},
     prelude{prelude},
+    relocatable{false},
+    symbolBases{},
+    imports{},
+    eliminateRoutines{false},
+    entryPoints{},
+    removedRoutines{},
+    symbolDatabases{},
+    profiler{nullptr},
+    memoryReport{nullptr},
+    listing{nullptr},
+    streamedMacros{},
     binaryFiles{},
+    dependencies{},
+    dependencyHashes{},
     sections{},
-    instructionSet{}
+    instructionSet{instructionSet},
+    parseCache{parseCache}
 {
     switch (sectionMode) {
         case SectionMode::ROM:
@@ -37,16 +50,109 @@ Assembler::Assembler(
             break;
     }
 
+    this->resetSymbols();
+}
+
+Assembler::~Assembler() {
+    this->deleteStreamedMacros();
+}
+
+void Assembler::resetSymbols() {
+    this->symbols = this->definitions;
+    this->symbolBases.clear();
+    this->imports.clear();
     symbols[Identifier{"ROM"}] = sectionMode == SectionMode::ROM ? 1 : 0;
     symbols[Identifier{"RAM"}] = sectionMode == SectionMode::RAM ? 1 : 0;
 }
 
-Assembler::~Assembler() {
-    //int i = 0;
-    for (auto& parsed : this->parsedFiles) {
-        //std::cout << parsed.first << '\n';
-        delete parsed.second;
+void Assembler::setDefinitions(std::map<Identifier, std::int64_t> definitions) {
+    this->definitions = definitions;
+    this->resetSymbols();
+}
+
+const std::map<Identifier, std::int64_t>& Assembler::getDefinitions() const {
+    return this->definitions;
+}
+
+SectionMode Assembler::getSectionMode() const {
+    return this->sectionMode;
+}
+
+const std::optional<std::string>& Assembler::getPrelude() const {
+    return this->prelude;
+}
+
+void Assembler::setRelocatable(bool relocatable) {
+    this->relocatable = relocatable;
+}
+
+bool Assembler::isRelocatable() const {
+    return this->relocatable;
+}
+
+void Assembler::setRoutineElimination(
+    bool enabled,
+    std::set<std::string> entryPoints
+) {
+    this->eliminateRoutines = enabled;
+    this->entryPoints = entryPoints;
+}
+
+bool Assembler::isEliminatingRoutines() const {
+    return this->eliminateRoutines && !this->relocatable;
+}
+
+const std::set<std::string>& Assembler::getEntryPoints() const {
+    return this->entryPoints;
+}
+
+bool Assembler::isRoutineRemoved(const std::string& name) const {
+    return this->removedRoutines.contains(name);
+}
+
+void Assembler::setSymbolDatabases(std::vector<const SymbolDatabase*> databases) {
+    this->symbolDatabases = databases;
+}
+
+const std::vector<const SymbolDatabase*>& Assembler::getSymbolDatabases() const {
+    return this->symbolDatabases;
+}
+
+void Assembler::setProfiler(Profiler* profiler) {
+    this->profiler = profiler;
+}
+
+Profiler* Assembler::getProfiler() const {
+    return this->profiler;
+}
+
+void Assembler::setMemoryReport(MemoryReport* report) {
+    this->memoryReport = report;
+}
+
+void Assembler::setListing(std::ostream* stream) {
+    this->listing = stream;
+}
+
+std::ostream* Assembler::getListing() const {
+    return this->listing;
+}
+
+std::optional<RelocationBase> Assembler::getSymbolBase(
+    const Identifier& identifier
+) const {
+    auto base = this->symbolBases.find(identifier);
+    if (base == this->symbolBases.end()) {
+        return std::nullopt;
     }
+    return base->second;
+}
+
+void Assembler::setSymbolBase(
+    const Identifier& identifier,
+    RelocationBase base
+) {
+    this->symbolBases[identifier] = base;
 }
 
 void hexdump(std::span<char> bytes) {
@@ -75,14 +181,21 @@ void hexdump(std::span<char> bytes) {
 
 /// Assembling
 
-Context Assembler::passes(const std::string& fileName) {
+void Assembler::passes(Context& context, const std::string& fileName) {
     const int maxPasses = 2;
     std::vector<Error> previousErrors{};
+    std::size_t previousSuppressed = 0;
 
     int pass = 0;
     for (;;) {
         //std::clog << "PASS: " << pass << '\n';
-        Context context = Context{this};
+        context.reset();
+        this->deleteStreamedMacros();
+
+        auto start = ProfileClock::now();
+        if (this->profiler) {
+            context.profile = &this->profiler->beginPass();
+        }
 
         if (this->prelude.has_value()) {
             this->assemble(context, this->prelude.value());
@@ -90,11 +203,34 @@ Context Assembler::passes(const std::string& fileName) {
 
         this->assemble(context, fileName);
 
+        if (this->profiler) {
+            auto end = ProfileClock::now();
+            context.profile->time = end - start;
+            for (const auto& section : context.sections) {
+                context.profile->bytes += section.second.getBytes().size();
+            }
+            this->profiler->record(
+                "pass",
+                std::format("pass {}", context.profile->number),
+                0,
+                start,
+                end
+            );
+        }
+
+        // Budgets are checked against what the pass recorded, so a pass
+        // which found budgets without recording runs again.
+        if (!context.cycleBudgets.empty() && !context.listing) {
+            context.listing = true;
+            continue;
+        }
+
         if (!context.hasErrors() 
-            || previousErrors == context.getErrors()
+            || (previousErrors == context.getErrors()
+                && previousSuppressed == context.getSuppressedErrors())
             || context.hasErrorLevel(Error::Level::Syntax)
         ) {
-            return context;
+            return;
         }
 
         if (pass++ >= maxPasses) {
@@ -105,106 +241,506 @@ Context Assembler::passes(const std::string& fileName) {
                     maxPasses
                 )
             );
-            return context;
+            return;
+        }
+
+        // Swapped rather than moved so that both keep their capacity.
+        std::swap(previousErrors, context.errors);
+        previousSuppressed = context.getSuppressedErrors();
+    }
+}
+
+Context Assembler::build(const std::string& fileName, std::ostream& report) {
+    this->resetSymbols();
+    this->removedRoutines.clear();
+
+    // Every pass, including those of the runs below, reuses the context
+    // and the vectors it grew.
+    Context context{this};
+    this->passes(context, fileName);
+
+    if (this->relocatable && this->importUnresolved(context)) {
+        this->passes(context, fileName);
+    }
+
+    if (this->isEliminatingRoutines() && !context.hasErrors()) {
+        std::set<std::string> removed{};
+        {
+            ProfileSpan span{this->profiler, "eliminate", "routines"};
+            removed = this->findUnreferencedRoutines(context);
+        }
+
+        if (!removed.empty()) {
+            std::map<std::string, std::int64_t> sizes{};
+            auto& starts = context.routineStarts;
+            std::int64_t end = context.sections["code"].getOffset().value_or(0);
+            const auto& layout = context.layoutOffsets;
+            for (std::size_t i = 0; i < starts.size(); ++i) {
+                std::int64_t next = i + 1 < starts.size() ? starts[i + 1].second : end;
+
+                // Padding before the next routine is not reclaimed.
+                auto padding = std::upper_bound(
+                    layout.begin(),
+                    layout.end(),
+                    starts[i].second
+                );
+                if (padding != layout.end() && *padding < next) {
+                    next = *padding;
+                }
+                sizes[starts[i].first] += next - starts[i].second;
+            }
+
+            // Addresses change once routines are gone, so start over.
+            this->resetSymbols();
+            this->removedRoutines = removed;
+            this->passes(context, fileName);
+
+            std::int64_t total = 0;
+            for (const auto& name : removed) {
+                report << std::format(
+                    "removed unreferenced routine '{}' ({} bytes)\n",
+                    name,
+                    sizes[name]
+                );
+                total += sizes[name];
+            }
+            report << std::format(
+                "reclaimed {} bytes from {} routines\n",
+                total,
+                removed.size()
+            );
         }
+    }
+
+    if (this->relocatable && !context.hasErrors()) {
+        this->checkExports(context);
+    }
+
+    if (!context.hasErrors()) {
+        checkCycleBudgets(context);
+    }
 
-        previousErrors = std::move(context.errors);
+    this->dependencies = context.dependencies;
+    this->dependencyHashes = context.dependencyHashes;
+    for (const auto* database : this->symbolDatabases) {
+        this->dependencies.insert(database->getPath());
+        this->dependencyHashes[database->getPath()] = database->getHash();
     }
+    return context;
 }
 
-bool Assembler::run(const std::string& fileName) {
-    Context context = passes(fileName);
+bool Assembler::run(
+    const std::string& fileName,
+    std::ostream& output,
+    std::ostream& errors
+) {
+    Context context = this->build(fileName, errors);
+
+    if (this->memoryReport) {
+        this->addMemoryUsage(context, *this->memoryReport);
+    }
 
     if (context.hasErrors()) {
-        context.displayErrors(std::clog);
+        context.displayErrors(errors);
         return false;
     }
 
+    if (this->listing) {
+        writeListing(context, *this->listing);
+    }
+
+    if (this->relocatable) {
+        this->getObjectFile(context).write(output);
+        return true;
+    }
+
     auto bytes = context.sections["code"].getBytes();
 
-    std::cout.write(bytes.data(), bytes.size());
+    output.write(bytes.data(), bytes.size());
     //hexdump(bytes);
 
     return true;
 }
 
-bool Assembler::assemble(
-    Context& context,
-    const std::string& fileName,
-    std::optional<Location> location
-) {
-    auto parsed = this->getParsedFile(context, fileName, location);
-    if (!parsed) {
-        return false;
+std::set<std::string> Assembler::findUnreferencedRoutines(
+    const Context& context
+) const {
+    std::set<std::string> routines{};
+    for (const auto& start : context.routineStarts) {
+        routines.insert(start.first);
     }
 
-    if (parsed->once && context.markAsIncluded(fileName)) {
-        return true;
+    // Roots are the routine at the start of the section, routines at fixed
+    // addresses, the entry points, and anything referenced from outside an
+    // operand.
+    std::vector<std::string> pending{
+        context.fixedRoutines.begin(),
+        context.fixedRoutines.end()
+    };
+    pending.insert(pending.end(), this->entryPoints.begin(), this->entryPoints.end());
+
+    for (const auto& start : context.routineStarts) {
+        if (start.second == 0) {
+            pending.push_back(start.first);
+        }
     }
 
-    return this->assemble(context, parsed->statements);
+    if (context.routineReferences.contains("")) {
+        const auto& references = context.routineReferences.at("");
+        pending.insert(pending.end(), references.begin(), references.end());
+    }
+
+    std::set<std::string> reached{};
+    while (!pending.empty()) {
+        std::string name = std::move(pending.back());
+        pending.pop_back();
+
+        if (!reached.insert(name).second) {
+            continue;
+        }
+
+        auto references = context.routineReferences.find(name);
+        if (references != context.routineReferences.end()) {
+            pending.insert(
+                pending.end(),
+                references->second.begin(),
+                references->second.end()
+            );
+        }
+    }
+
+    std::set<std::string> unreferenced{};
+    for (const auto& name : routines) {
+        if (!reached.contains(name)) {
+            unreferenced.insert(name);
+        }
+    }
+    return unreferenced;
 }
 
+bool Assembler::importUnresolved(const Context& context) {
+    if (context.unresolved.empty()) {
+        return false;
+    }
 
-bool Assembler::assemble(
-    Context& context,
-    const std::vector<Statement*>& statements
-) {
-    for (auto& statement : statements) {
-        statement->assemble(context);
+    for (const auto& error : context.getErrors()) {
+        if (error.code != Error::Code::UnresolvedSymbol) {
+            return false;
+        }
+    }
+
+    for (const auto& identifier : context.unresolved) {
+        if (this->symbols.contains(identifier)) {
+            continue;
+        }
+
+        std::stringstream ss{};
+        ss << identifier;
+        this->symbols[identifier] = 0;
+        this->symbolBases[identifier] = RelocationBase{ss.str(), true};
+        this->imports.insert(identifier);
     }
     return true;
 }
 
+bool Assembler::isExported(const Identifier& identifier) const {
+    // Only top level symbols are visible to other modules.
+    return identifier.value.size() == 1
+        && identifier.value[0] != "ROM"
+        && identifier.value[0] != "RAM"
+        && !this->definitions.contains(identifier)
+        && !this->imports.contains(identifier);
+}
+
+void Assembler::checkExports(Context& context) const {
+    for (const auto& symbol : this->symbols) {
+        const auto& identifier = symbol.first;
+        auto base = this->getSymbolBase(identifier);
+        if (!base || !base->external || !this->isExported(identifier)) {
+            continue;
+        }
+
+        std::stringstream ss{};
+        ss << identifier;
+        auto location = context.symbolLocations.find(identifier);
+        context.error(
+            Error::Level::Fatal,
+            std::format(
+                "cannot export '{}', which is computed from imported symbol '{}'",
+                ss.str(),
+                base->name
+            ),
+            location != context.symbolLocations.end()
+                ? std::optional<Location>{location->second}
+                : std::nullopt
+        );
+    }
+}
+
+ObjectFile Assembler::getObjectFile(const Context& context) const {
+    ObjectFile object{};
+
+    for (const auto& section : context.sections) {
+        auto bytes = section.second.getBytes();
+        object.sections.push_back({
+            section.first,
+            section.second.getOffset().value_or(0),
+            std::vector<char>{bytes.begin(), bytes.end()}
+        });
+    }
+
+    for (const auto& symbol : this->symbols) {
+        const auto& identifier = symbol.first;
+        if (!this->isExported(identifier)) {
+            continue;
+        }
+
+        std::stringstream ss{};
+        ss << identifier;
+        ObjectSymbol exported{ss.str(), symbol.second, std::nullopt};
+
+        auto base = this->getSymbolBase(identifier);
+        if (base) {
+            ASSEMBLER_ASSERT(!base->external, "export relative to an import");
+            exported.value -= this->sections.at(base->name).start;
+            exported.section = base->name;
+        }
+        object.exports.push_back(exported);
+    }
+
+    for (const auto& identifier : this->imports) {
+        std::stringstream ss{};
+        ss << identifier;
+        object.imports.push_back(ss.str());
+    }
+
+    object.relocations = context.relocations;
+    return object;
+}
+
+bool Assembler::link(
+    const std::vector<ObjectFile>& objects,
+    const std::vector<std::string>& names,
+    std::ostream& output,
+    std::ostream& errors
+) {
+    bool success = true;
+
+    // Address of each section of each object.
+    std::vector<std::map<std::string, std::int64_t>> placements(objects.size());
+
+    for (std::size_t i = 0; i < objects.size(); ++i) {
+        for (const auto& section : objects[i].sections) {
+            if (!this->sections.contains(section.name)) {
+                printError(errors, std::format(
+                    "{}: section '{}' does not exist",
+                    names[i],
+                    section.name
+                ));
+                success = false;
+            }
+        }
+    }
+
+    for (const auto& info : this->sections) {
+        std::int64_t address = info.second.start;
+        for (std::size_t i = 0; i < objects.size(); ++i) {
+            for (const auto& section : objects[i].sections) {
+                if (section.name == info.first) {
+                    placements[i][section.name] = address;
+                    address += section.size;
+                }
+            }
+        }
+
+        if (address > info.second.end) {
+            printError(errors, std::format(
+                "section '{}' overflows by {} bytes",
+                info.first,
+                address - info.second.end
+            ));
+            success = false;
+        }
+    }
+
+    this->resetSymbols();
+    std::map<Identifier, std::string> definedIn{};
+
+    for (std::size_t i = 0; i < objects.size(); ++i) {
+        for (const auto& symbol : objects[i].exports) {
+            std::int64_t value = symbol.value;
+            if (symbol.section) {
+                if (!placements[i].contains(*symbol.section)) {
+                    printError(errors, std::format(
+                        "{}: symbol '{}' refers to missing section '{}'",
+                        names[i],
+                        symbol.name,
+                        *symbol.section
+                    ));
+                    success = false;
+                    continue;
+                }
+                value += placements[i][*symbol.section];
+            }
+
+            auto identifier = UnqualifiedIdentifier::fromString(symbol.name).identifier;
+            if (definedIn.contains(identifier)) {
+                printError(errors, std::format(
+                    "symbol '{}' is defined in both '{}' and '{}'",
+                    symbol.name,
+                    definedIn[identifier],
+                    names[i]
+                ));
+                success = false;
+                continue;
+            }
+
+            definedIn[identifier] = names[i];
+            this->symbols[identifier] = value;
+        }
+    }
+
+    // Only the code section is part of the image, as in `run`.
+    const std::int64_t start = this->sections.at("code").start;
+    std::vector<char> image{};
+
+    for (std::size_t i = 0; i < objects.size(); ++i) {
+        for (const auto& section : objects[i].sections) {
+            if (section.name == "code") {
+                image.insert(image.end(), section.bytes.begin(), section.bytes.end());
+            }
+        }
+    }
+
+    for (std::size_t i = 0; i < objects.size(); ++i) {
+        for (const auto& relocation : objects[i].relocations) {
+            std::optional<std::int64_t> target{};
+            if (relocation.base.external) {
+                target = this->resolveSymbol(
+                    UnqualifiedIdentifier::fromString(relocation.base.name).identifier
+                );
+            } else if (placements[i].contains(relocation.base.name)) {
+                target = placements[i][relocation.base.name];
+            }
+
+            if (!target) {
+                printError(errors, std::format(
+                    "{}: undefined symbol '{}'",
+                    names[i],
+                    relocation.base.name
+                ));
+                success = false;
+                continue;
+            }
+
+            const int width = relocation.size == Size::Word ? 2 : 1;
+            const int shift = relocation.size == Size::Page ? 1 : 0;
+            std::int64_t position = relocation.section == "code"
+                    && placements[i].contains("code")
+                ? placements[i]["code"] - start + relocation.offset
+                : -1;
+
+            if (position < 0
+                || position + width > static_cast<std::int64_t>(image.size())
+            ) {
+                printError(errors, std::format(
+                    "{}: relocation outside of the code section",
+                    names[i]
+                ));
+                success = false;
+                continue;
+            }
+
+            std::int64_t value = *target + relocation.addend;
+            for (int j = 0; j < width; ++j) {
+                image[position + j] = (value >> ((j + shift) * 8)) & 0xff;
+            }
+        }
+    }
+
+    if (!success) {
+        return false;
+    }
 
-/// Parsing
+    output.write(image.data(), image.size());
+    return true;
+}
 
-Block* Assembler::getParsedFile(
+bool Assembler::assemble(
     Context& context,
     const std::string& fileName,
     std::optional<Location> location
 ) {
-    if (this->parsedFiles.contains(fileName)) {
-        return this->parsedFiles[fileName];
+    auto parsedFile = this->parseCache.getParsedFile(context, fileName, location);
+    if (!parsedFile) {
+        return false;
     }
 
-    //std::cout << fileName << ": " << std::filesystem::exists(fileName) << '\n';
+    if (parsedFile->path) {
+        context.dependencies.insert(*parsedFile->path);
+        context.dependencyHashes[*parsedFile->path] = parsedFile->hash;
+    }
 
-    auto file = openFile(context, fileName, this->includePath, location);
+    auto parsed = parsedFile->block;
 
-    if (!file.has_value()) {
-        return {};
+    if (parsed->once && context.markAsIncluded(fileName)) {
+        return true;
     }
 
-    auto parsed = this->parseFile(file.value(), fileName);
-    if (!parsed) {
-        context.error(
-            Error::Level::Syntax,
-            "failed to parse file",
-            location
-        );
-        return nullptr;
+    context.fileNames.push_back(fileName);
+    bool result = this->assemble(context, parsed->statements);
+    context.fileNames.pop_back();
+
+    // A file which includes itself is released by its outermost use.
+    if (this->parseCache.isStreaming()
+        && std::find(
+            context.fileNames.begin(),
+            context.fileNames.end(),
+            fileName
+        ) == context.fileNames.end()
+    ) {
+        this->releaseFile(context, fileName);
     }
+    return result;
+}
 
-    std::fclose(*file);
+void Assembler::releaseFile(Context& context, const std::string& fileName) {
+    std::set<const Statement*> macros{};
+    for (const auto& macro : context.macros) {
+        macros.insert(macro.second);
+    }
+
+    auto detached = this->parseCache.release(fileName, macros);
+    this->streamedMacros.insert(
+        this->streamedMacros.end(),
+        detached.begin(),
+        detached.end()
+    );
+}
 
-    this->parsedFiles[fileName] = parsed;
-    return this->parsedFiles[fileName];
+void Assembler::deleteStreamedMacros() {
+    for (auto* macro : this->streamedMacros) {
+        delete macro;
+    }
+    this->streamedMacros.clear();
 }
 
-Block* Assembler::parseFile(
-    FILE* file,
-    const std::string& fileName
+
+bool Assembler::assemble(
+    Context& context,
+    const std::vector<Statement*>& statements
 ) {
-    Driver driver{fileName};
-    yyin = file;
+    if (context.profile) {
+        context.profile->statements += statements.size();
+    }
 
-    if (driver.parseFile()) {
-        return nullptr;
+    for (auto& statement : statements) {
+        statement->assemble(context);
     }
-    return driver.parsed;
+    return true;
 }
 
+
 /// Symbols
 
 std::optional<std::int64_t> Assembler::resolveSymbol(
@@ -214,11 +750,18 @@ std::optional<std::int64_t> Assembler::resolveSymbol(
         return std::nullopt;
     }
 
-    if (!this->symbols.contains(*identifier)) {
-        return std::nullopt;
+    auto symbol = this->symbols.find(*identifier);
+    if (symbol != this->symbols.end()) {
+        return symbol->second;
     }
 
-    return this->symbols.at(*identifier);
+    for (const auto* database : this->symbolDatabases) {
+        auto value = database->lookup(*identifier);
+        if (value) {
+            return value;
+        }
+    }
+    return std::nullopt;
 }
 
 bool Assembler::assignSymbol(
@@ -231,8 +774,9 @@ bool Assembler::assignSymbol(
         return false;
     }
 
-    auto existing = this->resolveSymbol(*identifier);
-    if (existing && *existing != value) {
+    // Imported symbols may be shadowed, so only look at our own.
+    auto existing = this->symbols.find(*identifier);
+    if (existing != this->symbols.end() && existing->second != value) {
         std::stringstream ss{};
         ss << "redefinition of \'" << *identifier << "\'";
         context.error(Error::Level::Fatal, ss.str(), location);
@@ -240,9 +784,74 @@ bool Assembler::assignSymbol(
     }
 
     this->symbols[identifier.value()] = value;
+    context.symbolLocations.try_emplace(identifier.value(), location);
     return true;
 }
 
+const std::map<Identifier, std::int64_t>& Assembler::getSymbols() const {
+    return this->symbols;
+}
+
+void Assembler::writeSymbolDatabase(std::ostream& stream) const {
+    const std::set<Identifier> predefined{Identifier{"ROM"}, Identifier{"RAM"}};
+
+    std::map<Identifier, std::int64_t> symbols{};
+    for (const auto& symbol : this->symbols) {
+        if (!this->definitions.contains(symbol.first)
+            && !predefined.contains(symbol.first)
+        ) {
+            symbols.insert(symbol);
+        }
+    }
+    SymbolDatabase::write(symbols, stream);
+}
+
+void Assembler::addMemoryUsage(
+    const Context& context,
+    MemoryReport& report
+) const {
+    this->parseCache.addMemoryUsage(report);
+
+    // Names qualified inside a macro or repeat block have a part made from
+    // the enclosing frames, which starts with "__".
+    auto& symbols = report.categories["symbols"];
+    for (const auto& symbol : this->symbols) {
+        bool generated = std::any_of(
+            symbol.first.value.begin(),
+            symbol.first.value.end(),
+            [](const std::string& part) { return part.starts_with("__"); }
+        );
+        symbols[generated ? "generated locals" : "entries"].add(
+            treeNodeSize<std::pair<const Identifier, std::int64_t>>
+        );
+        symbols[generated ? "generated local names" : "entry names"].add(
+            getHeapSize(symbol.first)
+        );
+    }
+    for (const auto& location : context.symbolLocations) {
+        symbols["locations"].add(
+            treeNodeSize<std::pair<const Identifier, Location>>
+            + getHeapSize(location.first)
+        );
+    }
+    for (const auto& label : context.labels) {
+        symbols["labels"].add(treeNodeSize<Identifier> + getHeapSize(label));
+    }
+
+    auto& errors = report.categories["errors"];
+    for (const auto& error : context.errors) {
+        const char* level = error.level == Error::Level::Pass ? "pass"
+            : error.level == Error::Level::Fatal ? "fatal"
+            : "syntax";
+        errors[level].add(sizeof(Error) + getHeapSize(error.message));
+    }
+
+    auto& sections = report.categories["sections"];
+    for (const auto& section : context.sections) {
+        sections[section.first].add(sizeof(Section) + section.second.getCapacity());
+    }
+}
+
 void Assembler::printSymbols(std::ostream& stream) {
     for (auto& symbol : this->symbols) {
         stream
@@ -263,32 +872,23 @@ void Assembler::createSection(
     sections[name] = SectionInfo{name, writable, start, end};
 }
 
-bool fileExists(const std::filesystem::path& fileName) {
-    //std::cout << fileName << "\n";
-    if (!std::filesystem::exists(fileName)
-        || std::filesystem::is_directory(fileName)
-    ) {
-        return false;
-    }
-    return true;
-}
-
 std::optional<std::string> getFileName(
     Context& context,
     const std::string& fileName,
-    const std::span<std::string_view> includePath,
-    const std::optional<Location>& location
+    const std::span<const std::string> includePath,
+    const std::optional<Location>& location,
+    const FileProvider& fileProvider
 ) {
     //std::filesystem::path filePath{fileName};
 
-    if (fileExists(fileName)) {
+    if (fileProvider.exists(fileName)) {
         return {fileName};
     } 
 
     for (auto prefix : includePath) {
         auto stdPath = std::filesystem::path{prefix} / fileName;
 
-        if (fileExists(stdPath)) {
+        if (fileProvider.exists(stdPath.string())) {
             return stdPath.string();
         }
     }
@@ -304,7 +904,7 @@ std::optional<std::string> getFileName(
 std::optional<FILE*> openFile(
     Context& context,
     const std::string& fileName,
-    const std::span<std::string_view> includePath,
+    const std::span<const std::string> includePath,
     const std::optional<Location>& location
 ) {
     if (fileName == "stdin") {
@@ -5,12 +5,18 @@
 #include "Identifier.hpp"
 #include "Section.hpp"
 #include "SectionInfo.hpp"
+#include "ParseCache.hpp"
+#include "ObjectFile.hpp"
+#include "SymbolDatabase.hpp"
+#include "Profiler.hpp"
+#include "MemoryReport.hpp"
 #include <SpdrFirmware/InstructionSet.hpp>
 #include <SpdrFirmware/MicroSequence.hpp>
 #include <cstdint>
 #include <cstdio>
 #include <vector>
 #include <map>
+#include <set>
 #include <string>
 #include <optional>
 #include <span>
@@ -26,40 +32,100 @@ class Context;
 class Assembler {
 private:
     std::map<Identifier, std::int64_t> symbols;
-    std::map<std::string, Block*> parsedFiles;
-    const std::span<std::string_view> includePath;
+    std::map<Identifier, std::int64_t> definitions;
     const SectionMode sectionMode;
     const std::optional<std::string> prelude;
 
-    //std::map<int, std::map<int, std::int64_t>> numericLabels;
+    // Relocatable assembly records what each label is relative to and
+    // imports symbols the module does not define.
+    bool relocatable;
+    std::map<Identifier, RelocationBase> symbolBases;
+    std::set<Identifier> imports;
 
-    Block* getParsedFile(
-        Context& context,
-        const std::string& fileName,
-        std::optional<Location> location = {}
-    );
+    // Routines nothing reaches from the entry points are left out of the
+    // image when elimination is enabled.
+    bool eliminateRoutines;
+    std::set<std::string> entryPoints;
+    std::set<std::string> removedRoutines;
 
-    Block* parseFile(
-        FILE* file,
-        const std::string& fileName
-    );
+    // Symbols of other programs, used for names this one does not define.
+    std::vector<const SymbolDatabase*> symbolDatabases;
+
+    // Null unless the build is being profiled.
+    Profiler* profiler;
+
+    // Null unless the memory of the build is being reported.
+    MemoryReport* memoryReport;
+
+    // Null unless a listing is being written.
+    std::ostream* listing;
+
+    // Streaming only. Macros defined by released files, which the context
+    // uses until the next pass starts.
+    std::vector<Statement*> streamedMacros;
+
+    // Streaming only. Releases `fileName` once assembled, keeping the
+    // macros it defined.
+    void releaseFile(Context& context, const std::string& fileName);
+
+    void deleteStreamedMacros();
+
+    void addMemoryUsage(const Context& context, MemoryReport& report) const;
 
-    Context passes(const std::string& fileName);
+    void resetSymbols();
+
+    std::set<std::string> findUnreferencedRoutines(const Context& context) const;
+
+    bool importUnresolved(const Context& context);
+
+    // True if `identifier` is visible to other modules.
+    bool isExported(const Identifier& identifier) const;
+
+    // Adds an error for each exported symbol computed from an import, which
+    // object files cannot express.
+    void checkExports(Context& context) const;
+
+    //std::map<int, std::map<int, std::int64_t>> numericLabels;
+
+    // Assembles `fileName` into `context` until the errors settle, resetting
+    // it before each pass.
+    void passes(Context& context, const std::string& fileName);
 
 public:
     std::map<std::string, std::vector<char>> binaryFiles;
 
-    std::map<std::string, SectionInfo> sections;
-    const InstructionSet instructionSet;
+    // Files read during the final pass of the last run, and the hash of
+    // the contents the run used.
+    std::set<std::string> dependencies;
+    std::map<std::string, std::size_t> dependencyHashes;
 
-    Assembler(SectionMode sectionMode, const std::span<std::string_view> includePath, std::optional<std::string> prelude);
+    std::map<std::string, SectionInfo> sections;
+    const InstructionSet& instructionSet;
+    ParseCache& parseCache;
+
+    Assembler(
+        SectionMode sectionMode,
+        const InstructionSet& instructionSet,
+        ParseCache& parseCache,
+        std::optional<std::string> prelude
+    );
     ~Assembler();
 
     Assembler(const Assembler&) = delete;
     Assembler& operator=(const Assembler&) = delete;
 
 
-    bool run(const std::string& fileName);
+    // Assembles `fileName` and returns the context of the final pass.
+    // Notes about the build, such as removed routines, go to `report`.
+    Context build(const std::string& fileName, std::ostream& report);
+
+    bool run(
+        const std::string& fileName,
+        std::ostream& output,
+        std::ostream& errors
+    );
+
+    ObjectFile getObjectFile(const Context& context) const;
 
     bool assemble(
         Context& context,
@@ -83,8 +149,74 @@ public:
         std::int64_t value
     );
 
+    // Symbols defined before assembly starts, such as from the command line.
+    void setDefinitions(std::map<Identifier, std::int64_t> definitions);
+
+    const std::map<Identifier, std::int64_t>& getDefinitions() const;
+
+    SectionMode getSectionMode() const;
+
+    const std::optional<std::string>& getPrelude() const;
+
+    // Makes `run` write an object file instead of an image.
+    void setRelocatable(bool relocatable);
+
+    bool isRelocatable() const;
+
+    // Enables unreferenced routine elimination, keeping `entryPoints` and
+    // everything they reference.
+    void setRoutineElimination(bool enabled, std::set<std::string> entryPoints);
+
+    bool isEliminatingRoutines() const;
+
+    const std::set<std::string>& getEntryPoints() const;
+
+    bool isRoutineRemoved(const std::string& name) const;
+
+    std::optional<RelocationBase> getSymbolBase(const Identifier& identifier) const;
+
+    void setSymbolBase(const Identifier& identifier, RelocationBase base);
+
+    // Places the sections of `objects` one after the other and writes the
+    // image with all relocations resolved.
+    bool link(
+        const std::vector<ObjectFile>& objects,
+        const std::vector<std::string>& names,
+        std::ostream& output,
+        std::ostream& errors
+    );
+
+    // Makes the symbols in `databases` visible to the program, searched in
+    // order. They are read only, and the program's own symbols shadow them.
+    void setSymbolDatabases(std::vector<const SymbolDatabase*> databases);
+
+    const std::vector<const SymbolDatabase*>& getSymbolDatabases() const;
+
+    // Writes the symbols defined by the program, leaving out predefined
+    // and imported ones.
+    void writeSymbolDatabase(std::ostream& stream) const;
+
+    // Makes builds report their passes and spans to `profiler`, or stops
+    // profiling with null.
+    void setProfiler(Profiler* profiler);
+
+    Profiler* getProfiler() const;
+
+    // Makes `run` add what the build holds once assembled, with the final
+    // pass, to `report`, or stops with null.
+    void setMemoryReport(MemoryReport* report);
+
+    // Makes `run` write a listing of a successful build to `stream`, or
+    // stops with null. Listed builds assemble every iteration of repeat
+    // blocks, to list each.
+    void setListing(std::ostream* stream);
+
+    std::ostream* getListing() const;
+
     void createSection(std::string name, bool writable, std::int64_t start, std::int64_t);
 
+    const std::map<Identifier, std::int64_t>& getSymbols() const;
+
     void printSymbols(std::ostream& stream);
 
     //bool defineMacro(Macro macro, std::vector<Statement*> statements, int uid);
@@ -93,14 +225,15 @@ public:
 std::optional<std::string> getFileName(
     Context& context,
     const std::string& filename,
-    const std::span<std::string_view> includePath,
-    const std::optional<Location>& location = {}
+    const std::span<const std::string> includePath,
+    const std::optional<Location>& location = {},
+    const FileProvider& fileProvider = getDiskFileProvider()
 );
 
 std::optional<FILE*> openFile(
     Context& context,
     const std::string& fileName,
-    const std::span<std::string_view> includePath,
+    const std::span<const std::string> includePath,
     const std::optional<Location>& location = {}
 );
 
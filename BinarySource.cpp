@@ -0,0 +1,696 @@
+#include "BinarySource.hpp"
+#include "InstructionStatement.hpp"
+#include "MacroStatement.hpp"
+#include <SpdrFirmware/Mode.hpp>
+#include <SpdrFirmware/Register.hpp>
+#include <algorithm>
+#include <format>
+
+const std::string_view binaryMagic{"\0ASPB", 5};
+const std::uint8_t binaryVersion = 1;
+
+// Deeper nesting is rejected rather than risking the stack.
+const int maxBinaryDepth = 256;
+
+bool isBinarySource(std::string_view contents) {
+    return contents.starts_with(binaryMagic);
+}
+
+class BinaryReader {
+private:
+    std::string_view contents;
+    std::size_t position;
+    const std::string& fileName;
+    Location location;
+    int depth;
+
+public:
+    std::string error;
+
+    BinaryReader(std::string_view contents, const std::string& fileName);
+
+    bool fail(std::string message);
+
+    std::optional<std::uint8_t> readByte();
+    std::optional<std::uint64_t> readUnsigned();
+    std::optional<std::int64_t> readSigned();
+    std::optional<std::string> readString();
+    std::optional<UnqualifiedIdentifier> readIdentifier();
+    std::optional<Address> readAddress();
+
+    Expression* readExpression();
+    DataElement* readDataElement();
+    Statement* readStatement();
+    Block* readBlock();
+
+    void skip(std::size_t count);
+    bool atEnd() const;
+};
+
+BinaryReader::BinaryReader(std::string_view contents, const std::string& fileName)
+:   contents{contents},
+    position{0},
+    fileName{fileName},
+    location{&fileName},
+    depth{0},
+    error{} {}
+
+bool BinaryReader::fail(std::string message) {
+    if (this->error.empty()) {
+        this->error = std::format("{} at byte {}", message, this->position);
+    }
+    return false;
+}
+
+void BinaryReader::skip(std::size_t count) {
+    this->position = std::min(this->position + count, this->contents.size());
+}
+
+bool BinaryReader::atEnd() const {
+    return this->position == this->contents.size();
+}
+
+std::optional<std::uint8_t> BinaryReader::readByte() {
+    if (this->position >= this->contents.size()) {
+        this->fail("unexpected end of file");
+        return std::nullopt;
+    }
+    return static_cast<std::uint8_t>(this->contents[this->position++]);
+}
+
+std::optional<std::uint64_t> BinaryReader::readUnsigned() {
+    std::uint64_t value = 0;
+    for (int shift = 0; shift < 64; shift += 7) {
+        auto byte = this->readByte();
+        if (!byte) {
+            return std::nullopt;
+        }
+
+        value |= static_cast<std::uint64_t>(*byte & 0x7f) << shift;
+        if (!(*byte & 0x80)) {
+            return value;
+        }
+    }
+
+    this->fail("integer too long");
+    return std::nullopt;
+}
+
+std::optional<std::int64_t> BinaryReader::readSigned() {
+    auto value = this->readUnsigned();
+    if (!value) {
+        return std::nullopt;
+    }
+    return static_cast<std::int64_t>(*value >> 1) ^ -static_cast<std::int64_t>(*value & 1);
+}
+
+std::optional<std::string> BinaryReader::readString() {
+    auto size = this->readUnsigned();
+    if (!size) {
+        return std::nullopt;
+    }
+
+    if (*size > this->contents.size() - this->position) {
+        this->fail("string runs past end of file");
+        return std::nullopt;
+    }
+
+    std::string value{this->contents.substr(this->position, *size)};
+    this->position += *size;
+    return value;
+}
+
+std::optional<UnqualifiedIdentifier> BinaryReader::readIdentifier() {
+    auto depth = this->readUnsigned();
+    auto count = depth ? this->readUnsigned() : std::nullopt;
+    if (!count) {
+        return std::nullopt;
+    }
+
+    if (*count == 0) {
+        this->fail("empty identifier");
+        return std::nullopt;
+    }
+
+    std::vector<std::string> value{};
+    for (std::uint64_t i = 0; i < *count; ++i) {
+        auto component = this->readString();
+        if (!component) {
+            return std::nullopt;
+        }
+        value.push_back(std::move(*component));
+    }
+    return UnqualifiedIdentifier{value, *depth};
+}
+
+std::optional<Address> BinaryReader::readAddress() {
+    const RID registers[] = {RID::A, RID::C, RID::D, RID::CD, RID::F, RID::Sp};
+
+    auto mode = this->readByte();
+    auto reg = mode ? this->readByte() : std::nullopt;
+    if (!reg) {
+        return std::nullopt;
+    }
+
+    bool hasRegister = *mode == 0 || *mode == 3 || *mode == 4;
+    if (hasRegister && *reg >= std::size(registers)) {
+        this->fail(std::format("invalid register {}", *reg));
+        return std::nullopt;
+    }
+
+    switch (*mode) {
+        case 0:
+            return Address{registers[*reg]};
+        case 1:
+            return Address{Mode::Immediate};
+        case 2:
+            return Address{Mode::Direct};
+        case 3:
+            return Address{Mode::Indirect, registers[*reg]};
+        case 4:
+            return Address{Mode::Offset, registers[*reg]};
+    }
+
+    this->fail(std::format("invalid addressing mode {}", *mode));
+    return std::nullopt;
+}
+
+Expression* BinaryReader::readExpression() {
+    if (this->depth >= maxBinaryDepth) {
+        this->fail("expression nested too deeply");
+        return nullptr;
+    }
+
+    auto kind = this->readByte();
+    if (!kind) {
+        return nullptr;
+    }
+
+    ++this->depth;
+    Expression* expression = nullptr;
+
+    switch (*kind) {
+        case 1:
+        {
+            auto value = this->readSigned();
+            if (value) {
+                expression = new LiteralExpression{this->location, *value};
+            }
+        }
+            break;
+        case 2:
+        {
+            auto identifier = this->readIdentifier();
+            if (identifier) {
+                expression = new SymbolicExpression{this->location, *identifier};
+            }
+        }
+            break;
+        case 3:
+        {
+            auto operation = this->readByte();
+            if (operation && *operation > static_cast<std::uint8_t>(Unary::Not)) {
+                this->fail(std::format("invalid unary operator {}", *operation));
+                break;
+            }
+
+            auto operand = operation ? this->readExpression() : nullptr;
+            if (operand) {
+                expression = new UnaryExpression{
+                    this->location,
+                    static_cast<Unary>(*operation),
+                    operand
+                };
+            }
+        }
+            break;
+        case 4:
+        {
+            auto operation = this->readByte();
+            if (operation && *operation > static_cast<std::uint8_t>(Binary::NotEqual)) {
+                this->fail(std::format("invalid binary operator {}", *operation));
+                break;
+            }
+
+            auto operand0 = operation ? this->readExpression() : nullptr;
+            auto operand1 = operand0 ? this->readExpression() : nullptr;
+            if (!operand1) {
+                delete operand0;
+                break;
+            }
+
+            expression = new BinaryExpression{
+                this->location,
+                static_cast<Binary>(*operation),
+                operand0,
+                operand1
+            };
+        }
+            break;
+        case 5:
+        {
+            auto name = this->readString();
+            auto count = name ? this->readUnsigned() : std::nullopt;
+            if (!count) {
+                break;
+            }
+
+            std::vector<Expression*> arguments{};
+            for (std::uint64_t i = 0; i < *count; ++i) {
+                auto argument = this->readExpression();
+                if (!argument) {
+                    break;
+                }
+                arguments.push_back(argument);
+            }
+
+            if (arguments.size() != *count) {
+                for (auto argument : arguments) {
+                    delete argument;
+                }
+                break;
+            }
+            expression = new CallExpression{this->location, *name, arguments};
+        }
+            break;
+        default:
+            this->fail(std::format("invalid expression kind {}", *kind));
+            break;
+    }
+
+    --this->depth;
+    return expression;
+}
+
+DataElement* BinaryReader::readDataElement() {
+    auto kind = this->readByte();
+    if (!kind) {
+        return nullptr;
+    }
+
+    switch (*kind) {
+        case 1:
+        {
+            auto size = this->readByte();
+            if (!size) {
+                return nullptr;
+            }
+
+            if (*size > 2) {
+                this->fail(std::format("invalid data element size {}", *size));
+                return nullptr;
+            }
+
+            auto expression = this->readExpression();
+            if (!expression) {
+                return nullptr;
+            }
+
+            std::optional<int> elementSize{};
+            if (*size != 0) {
+                elementSize = *size;
+            }
+            return new ExpressionElement{this->location, expression, elementSize};
+        }
+        case 2:
+        {
+            auto data = this->readString();
+            if (!data) {
+                return nullptr;
+            }
+            return new StringElement{this->location, *data};
+        }
+        case 3:
+        {
+            auto count = this->readUnsigned();
+            if (!count) {
+                return nullptr;
+            }
+
+            std::vector<std::int64_t> values{};
+            for (std::uint64_t i = 0; i < *count; ++i) {
+                auto value = this->readSigned();
+                if (!value) {
+                    return nullptr;
+                }
+                values.push_back(*value);
+            }
+            return new IntegerListElement{this->location, std::move(values)};
+        }
+    }
+
+    this->fail(std::format("invalid data element kind {}", *kind));
+    return nullptr;
+}
+
+Statement* BinaryReader::readStatement() {
+    auto kind = this->readByte();
+    auto line = kind ? this->readUnsigned() : std::nullopt;
+    if (!line) {
+        return nullptr;
+    }
+
+    this->location = Location{&this->fileName, static_cast<int>(*line)};
+
+    switch (*kind) {
+        case 1:
+        {
+            auto id = this->readIdentifier();
+            if (!id) {
+                return nullptr;
+            }
+            return new LabelStatement{this->location, *id};
+        }
+        case 2:
+        case 9:
+        {
+            auto id = this->readIdentifier();
+            auto expression = id ? this->readExpression() : nullptr;
+            if (!expression) {
+                return nullptr;
+            }
+
+            if (*kind == 2) {
+                return new SymbolStatement{this->location, *id, expression};
+            }
+            return new VariableStatement{this->location, *id, expression};
+        }
+        case 3:
+        case 10:
+        {
+            auto name = this->readString();
+            if (!name) {
+                return nullptr;
+            }
+
+            if (*kind == 3) {
+                return new SectionStatement{this->location, *name};
+            }
+            return new ProvidesStatement{this->location, *name};
+        }
+        case 4:
+        case 5:
+        case 6:
+        {
+            auto expression = this->readExpression();
+            if (!expression) {
+                return nullptr;
+            }
+
+            if (*kind == 4) {
+                return new AddressStatement{this->location, expression};
+            }
+            if (*kind == 5) {
+                return new AlignStatement{this->location, expression};
+            }
+            return new ReserveStatement{this->location, expression};
+        }
+        case 7:
+        {
+            auto size = this->readByte();
+            auto count = size ? this->readUnsigned() : std::nullopt;
+            if (!count) {
+                return nullptr;
+            }
+
+            if (*size != 1 && *size != 2) {
+                this->fail(std::format("invalid data size {}", *size));
+                return nullptr;
+            }
+
+            std::vector<DataElement*> elements{};
+            for (std::uint64_t i = 0; i < *count; ++i) {
+                auto element = this->readDataElement();
+                if (!element) {
+                    for (auto previous : elements) {
+                        delete previous;
+                    }
+                    return nullptr;
+                }
+                elements.push_back(element);
+            }
+            return new DataStatement{this->location, elements, *size};
+        }
+        case 8:
+        {
+            auto type = this->readByte();
+            auto name = type ? this->readString() : std::nullopt;
+            if (!name) {
+                return nullptr;
+            }
+
+            if (*type > 1) {
+                this->fail(std::format("invalid include type {}", *type));
+                return nullptr;
+            }
+            return new IncludeStatement{
+                this->location,
+                *type == 0
+                    ? IncludeStatement::Type::Assembly
+                    : IncludeStatement::Type::Binary,
+                *name
+            };
+        }
+        case 11:
+        {
+            Location location = this->location;
+            auto condition = this->readExpression();
+            auto body = condition ? this->readBlock() : nullptr;
+            auto hasElse = body ? this->readByte() : std::nullopt;
+            auto elseBody = hasElse && *hasElse ? this->readBlock() : nullptr;
+
+            if (!hasElse || (*hasElse && !elseBody)) {
+                delete condition;
+                delete body;
+                return nullptr;
+            }
+
+            std::optional<Block*> elseBlock{};
+            if (elseBody) {
+                elseBlock = elseBody;
+            }
+            return new ConditionalStatement{location, condition, body, elseBlock};
+        }
+        case 12:
+        {
+            Location location = this->location;
+            auto times = this->readExpression();
+            auto hasCounter = times ? this->readByte() : std::nullopt;
+
+            std::optional<std::string> counter{};
+            if (hasCounter && *hasCounter) {
+                counter = this->readString();
+                if (!counter) {
+                    hasCounter = std::nullopt;
+                }
+            }
+
+            auto body = hasCounter ? this->readBlock() : nullptr;
+            if (!body) {
+                delete times;
+                return nullptr;
+            }
+            return new RepeatStatement{location, times, body, counter};
+        }
+        case 13:
+        {
+            const TableStatement::Type types[] = {
+                TableStatement::Type::Byte,
+                TableStatement::Type::Word,
+                TableStatement::Type::Split,
+            };
+
+            auto type = this->readByte();
+            auto index = type ? this->readString() : std::nullopt;
+            if (!index) {
+                return nullptr;
+            }
+
+            if (*type >= std::size(types)) {
+                this->fail(std::format("invalid table type {}", *type));
+                return nullptr;
+            }
+
+            auto start = this->readExpression();
+            auto end = start ? this->readExpression() : nullptr;
+            auto value = end ? this->readExpression() : nullptr;
+            if (!value) {
+                delete start;
+                delete end;
+                return nullptr;
+            }
+            return new TableStatement{
+                this->location,
+                types[*type],
+                *index,
+                start,
+                end,
+                value
+            };
+        }
+        case 14:
+        {
+            auto name = this->readString();
+            auto count = name ? this->readUnsigned() : std::nullopt;
+            if (!count) {
+                return nullptr;
+            }
+
+            std::vector<std::pair<Address, Expression*>> mode{};
+            bool valid = true;
+            for (std::uint64_t i = 0; valid && i < *count; ++i) {
+                auto address = this->readAddress();
+                auto hasExpression = address ? this->readByte() : std::nullopt;
+                Expression* expression = nullptr;
+                if (hasExpression && *hasExpression) {
+                    expression = this->readExpression();
+                }
+
+                valid = hasExpression && (!*hasExpression || expression);
+
+                // Immediate, direct and offset operands take an expression,
+                // and register and indirect ones do not.
+                bool needsExpression = valid
+                    && address->mode != Mode::Register
+                    && address->mode != Mode::Indirect;
+                if (valid && needsExpression != (*hasExpression != 0)) {
+                    this->fail(needsExpression
+                        ? "operand is missing its expression"
+                        : "operand does not take an expression"
+                    );
+                    delete expression;
+                    valid = false;
+                }
+
+                if (valid) {
+                    mode.push_back({*address, expression});
+                }
+            }
+
+            if (!valid) {
+                for (auto& operand : mode) {
+                    delete operand.second;
+                }
+                return nullptr;
+            }
+            return new InstructionStatement{this->location, *name, mode};
+        }
+        case 15:
+        {
+            Location location = this->location;
+            auto name = this->readString();
+            auto count = name ? this->readUnsigned() : std::nullopt;
+            if (!count) {
+                return nullptr;
+            }
+
+            std::vector<std::pair<Address, std::optional<std::string>>> parameters{};
+            for (std::uint64_t i = 0; i < *count; ++i) {
+                auto address = this->readAddress();
+                auto hasName = address ? this->readByte() : std::nullopt;
+                if (!hasName) {
+                    return nullptr;
+                }
+
+                std::optional<std::string> parameterName{};
+                if (*hasName) {
+                    parameterName = this->readString();
+                    if (!parameterName) {
+                        return nullptr;
+                    }
+                }
+                parameters.push_back({*address, parameterName});
+            }
+
+            auto block = this->readBlock();
+            if (!block) {
+                return nullptr;
+            }
+            return new MacroStatement{location, *name, parameters, block};
+        }
+        case 16:
+        {
+            auto start = this->readExpression();
+            auto end = start ? this->readExpression() : nullptr;
+            auto max = end ? this->readExpression() : nullptr;
+            if (!max) {
+                delete start;
+                delete end;
+                return nullptr;
+            }
+            return new CycleBudgetStatement{this->location, start, end, max};
+        }
+    }
+
+    this->fail(std::format("invalid statement kind {}", *kind));
+    return nullptr;
+}
+
+Block* BinaryReader::readBlock() {
+    if (this->depth >= maxBinaryDepth) {
+        this->fail("blocks nested too deeply");
+        return nullptr;
+    }
+
+    auto count = this->readUnsigned();
+    if (!count) {
+        return nullptr;
+    }
+
+    ++this->depth;
+    Block* block = new Block{};
+    for (std::uint64_t i = 0; i < *count; ++i) {
+        auto statement = this->readStatement();
+        if (!statement) {
+            delete block;
+            block = nullptr;
+            break;
+        }
+        block->push(statement);
+    }
+    --this->depth;
+
+    return block;
+}
+
+Block* readBinarySource(
+    std::string_view contents,
+    const std::string& fileName,
+    std::string& error
+) {
+    if (!isBinarySource(contents)) {
+        error = "not a pre-tokenized source";
+        return nullptr;
+    }
+
+    BinaryReader body{contents, fileName};
+    body.skip(binaryMagic.size());
+
+    auto version = body.readByte();
+    auto flags = version ? body.readByte() : std::nullopt;
+    if (!flags) {
+        error = body.error;
+        return nullptr;
+    }
+
+    if (*version != binaryVersion) {
+        error = std::format("unsupported pre-tokenized source version {}", *version);
+        return nullptr;
+    }
+
+    Block* block = body.readBlock();
+    if (block && !body.atEnd()) {
+        body.fail("trailing data");
+        delete block;
+        block = nullptr;
+    }
+
+    if (!block) {
+        error = body.error;
+        return nullptr;
+    }
+
+    block->once = *flags & 1;
+    return block;
+}
+
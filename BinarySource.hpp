@@ -0,0 +1,74 @@
+#ifndef BINARYSOURCE_HPP
+#define BINARYSOURCE_HPP
+
+#include "Block.hpp"
+#include <optional>
+#include <string>
+#include <string_view>
+
+// Pre-tokenized sources let programs which generate assembly hand over
+// statements directly, skipping the scanner and parser. They are used in
+// place of a text file wherever one is included.
+//
+// A file starts with the five bytes 00 'A' 'S' 'P' 'B', a version byte (1)
+// and a flags byte (bit 0 marks the file as `once`), followed by a block.
+//
+// Encodings:
+//   uint       unsigned LEB128
+//   int        zigzag encoded, then as a uint
+//   string     uint length, then bytes
+//   identifier uint depth (leading dots), uint count, then count strings
+//   block      uint count, then count statements
+//
+// Statement: byte kind, uint line, then by kind
+//    1 label        identifier
+//    2 symbol       identifier, expression
+//    3 section      string
+//    4 address      expression
+//    5 align        expression
+//    6 reserve      expression
+//    7 data         byte default size (1 or 2), uint count, data elements
+//    8 include      byte type (0 assembly, 1 binary), string
+//    9 variable     identifier, expression
+//   10 provides     string
+//   11 if           expression, block, byte has else, [block]
+//   12 repeat       expression, byte has counter, [string], block
+//   13 table        byte type (0 byte, 1 word, 2 split), string index,
+//                   expression start, expression end, expression value
+//   14 instruction  string, uint count, count times: address,
+//                   byte has expression, [expression]
+//   15 macro        string, uint count, count times: address,
+//                   byte has name, [string]; block
+//   16 cycle budget expression start, expression end, expression max
+//
+// Address: byte mode, byte register. Modes are 0 register, 1 immediate,
+// 2 direct, 3 indirect and 4 offset; registers are 0 A, 1 C, 2 D, 3 CD,
+// 4 F and 5 SP, and ignored for immediate and direct.
+//
+// Expression: byte kind, then by kind
+//   1 literal  int
+//   2 symbol   identifier
+//   3 unary    byte operator (Unary order), expression
+//   4 binary   byte operator (Binary order), expression, expression
+//   5 call     string name, uint count, expressions
+//
+// Data element: byte kind, then by kind
+//   1 expression    byte size (0 for the statement default), expression
+//   2 string        string
+//   3 integer list  uint count, ints
+//
+// Expressions and data elements take the line of their statement.
+
+bool isBinarySource(std::string_view contents);
+
+// Builds the block for `contents`. Locations refer to `fileName`, which
+// must outlive the block. Returns nullptr and sets `error` if the contents
+// are malformed.
+Block* readBinarySource(
+    std::string_view contents,
+    const std::string& fileName,
+    std::string& error
+);
+
+#endif
+
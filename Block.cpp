@@ -19,3 +19,18 @@ bool Block::assemble(Context& context) {
     return context.assembler->assemble(context, this->statements);
 }
 
+bool Block::isIterationInvariant(const Context& context) const {
+    for (auto& elem : this->statements) {
+        if (!elem->isIterationInvariant(context)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void Block::addMemoryUsage(MemoryTallies& usage) const {
+    usage["Block"].add(sizeof(*this) + getHeapSize(this->statements));
+    for (const auto* statement : this->statements) {
+        statement->addMemoryUsage(usage);
+    }
+}
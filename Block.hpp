@@ -14,6 +14,9 @@ public:
 
     void push(Statement* statement);
     bool assemble(Context& context);
+    bool isIterationInvariant(const Context& context) const;
+
+    void addMemoryUsage(MemoryTallies& usage) const;
 };
 
 #endif
@@ -0,0 +1,805 @@
+#include "Command.hpp"
+#include "Assembler.hpp"
+#include "ArgumentParser.hpp"
+#include "Server.hpp"
+#include "LanguageServer.hpp"
+#include "Watch.hpp"
+#include "WorkPool.hpp"
+#include "OutputCache.hpp"
+#include "SymbolDatabase.hpp"
+#include "Profiler.hpp"
+#include "MemoryReport.hpp"
+#include "Error.hpp"
+#include <optional>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <set>
+#include <sstream>
+#include <stdexcept>
+#include <string_view>
+#include <thread>
+#include <unistd.h>
+
+// Writes `image` to `outfile` if given and to `output` otherwise.
+bool writeImage(
+    const std::string& image,
+    const std::string& outfile,
+    std::ostream& output,
+    std::ostream& errors
+) {
+    if (outfile.empty()) {
+        output << image;
+        return true;
+    }
+
+    std::ofstream file{outfile, std::ios::binary};
+    file << image;
+    if (!file) {
+        errors << "failed to write '" << outfile << "'\n";
+        return false;
+    }
+    return true;
+}
+
+// Assembles `infile`, writing the image to `outfile` if given and to
+// `output` otherwise. The output file is only replaced on success. With an
+// output cache, the result of an earlier run from the same inputs is used
+// instead of assembling.
+bool assembleTo(
+    Assembler& assembler,
+    const std::string& infile,
+    const std::string& outfile,
+    bool printSymbols,
+    std::ostream& output,
+    std::ostream& errors,
+    const OutputCache* outputCache = nullptr
+) {
+    std::optional<std::string> key{};
+    if (outputCache && infile != "stdin") {
+        key = outputCache->getKey(assembler, infile);
+
+        auto cached = outputCache->lookup(*key);
+        if (cached) {
+            assembler.dependencies.clear();
+            for (const auto& dependency : cached->dependencies) {
+                assembler.dependencies.insert(dependency.first);
+            }
+            assembler.dependencyHashes = cached->dependencies;
+            if (printSymbols) {
+                errors << cached->symbols;
+            }
+            return writeImage(cached->image, outfile, output, errors);
+        }
+    }
+
+    std::stringstream image{};
+    bool success = assembler.run(infile, image, errors);
+
+    std::stringstream symbols{};
+    assembler.printSymbols(symbols);
+    if (printSymbols) {
+        errors << symbols.str();
+    }
+
+    if (!success) {
+        return false;
+    }
+
+    if (key) {
+        outputCache->store(
+            *key,
+            CachedOutput{image.str(), symbols.str(), assembler.dependencyHashes}
+        );
+    }
+    return writeImage(image.str(), outfile, output, errors);
+}
+
+// Prints the time report and writes the trace of a profiled build.
+bool writeProfile(
+    const Profiler& profiler,
+    bool timeReport,
+    const std::string& traceFile,
+    std::ostream& errors
+) {
+    if (timeReport) {
+        profiler.writeReport(errors);
+    }
+
+    if (traceFile.empty()) {
+        return true;
+    }
+
+    std::ofstream file{traceFile};
+    profiler.writeTrace(file);
+    if (!file) {
+        errors << "failed to write '" << traceFile << "'\n";
+        return false;
+    }
+    return true;
+}
+
+// Flushes the listing written during the build.
+bool writeListingFile(
+    std::ofstream& file,
+    const std::string& path,
+    std::ostream& errors
+) {
+    file.close();
+    if (!file) {
+        errors << "failed to write '" << path << "'\n";
+        return false;
+    }
+    return true;
+}
+
+// Escapes a path for use in a make rule.
+std::string escapeMakePath(const std::string& path) {
+    std::string escaped{};
+    for (char c : path) {
+        if (c == ' ' || c == '#') {
+            escaped += '\\';
+        } else if (c == '$') {
+            escaped += '$';
+        }
+        escaped += c;
+    }
+    return escaped;
+}
+
+// Writes a make rule listing the files read by the last run of `assembler`,
+// followed by an empty rule per file so deleted includes don't break make.
+bool writeDepfile(
+    const Assembler& assembler,
+    const std::string& depfile,
+    const std::string& target,
+    std::ostream& errors
+) {
+    std::ofstream file{depfile};
+    file << escapeMakePath(target) << ':';
+    for (const auto& dependency : assembler.dependencies) {
+        file << " \\\n " << escapeMakePath(dependency);
+    }
+    file << '\n';
+
+    for (const auto& dependency : assembler.dependencies) {
+        file << '\n' << escapeMakePath(dependency) << ":\n";
+    }
+
+    if (!file) {
+        errors << "failed to write '" << depfile << "'\n";
+        return false;
+    }
+    return true;
+}
+
+// Writes the symbols of the last run of `assembler` as a symbol database.
+// Other builds may have the old database mapped, so it is replaced by
+// renaming rather than rewritten in place.
+bool writeSymbolDatabase(
+    const Assembler& assembler,
+    const std::string& path,
+    std::ostream& errors
+) {
+    std::string temporary = path + ".tmp";
+    std::ofstream file{temporary, std::ios::binary};
+    assembler.writeSymbolDatabase(file);
+    file.close();
+
+    bool written = static_cast<bool>(file);
+    std::error_code error{};
+    if (written) {
+        std::filesystem::rename(temporary, path, error);
+    }
+
+    if (!written || error) {
+        std::filesystem::remove(temporary, error);
+        errors << "failed to write '" << path << "'\n";
+        return false;
+    }
+    return true;
+}
+
+// Maps the symbol databases at `paths` into `storage`, replacing what it
+// held, and points `databases` at them.
+bool openSymbolDatabases(
+    const std::vector<std::string>& paths,
+    std::vector<SymbolDatabase>& storage,
+    std::vector<const SymbolDatabase*>& databases,
+    std::ostream& errors
+) {
+    databases.clear();
+    storage.clear();
+    for (const auto& path : paths) {
+        std::string error{};
+        auto database = SymbolDatabase::open(path, error);
+        if (!database) {
+            errors << error << '\n';
+            return false;
+        }
+        storage.push_back(std::move(*database));
+    }
+
+    for (const auto& database : storage) {
+        databases.push_back(&database);
+    }
+    return true;
+}
+
+using Definitions = std::map<Identifier, std::int64_t>;
+
+// Parses a NAME or NAME=VALUE symbol definition.
+bool parseDefinition(
+    std::string_view definition,
+    Definitions& definitions,
+    std::ostream& errors
+) {
+    auto equals = definition.find('=');
+    std::string name{definition.substr(0, equals)};
+    std::int64_t value = 1;
+
+    if (equals != std::string_view::npos) {
+        std::string text{definition.substr(equals + 1)};
+        try {
+            std::size_t length;
+            value = std::stoll(text, &length, 0);
+            if (length != text.size()) {
+                throw std::invalid_argument{text};
+            }
+        } catch (const std::logic_error&) {
+            errors << "invalid value in definition '" << definition << "'\n";
+            return false;
+        }
+    }
+
+    if (name.empty()) {
+        errors << "invalid definition '" << definition << "'\n";
+        return false;
+    }
+
+    definitions[UnqualifiedIdentifier::fromString(name).identifier] = value;
+    return true;
+}
+
+class Job {
+public:
+    std::string name;
+    std::string infile;
+    std::string outfile;
+    SectionMode sectionMode;
+    Definitions definitions;
+    bool relocatable;
+    bool eliminateRoutines;
+    std::set<std::string> entryPoints;
+};
+
+// Parses a configuration of the form OUTFILE[:OPTION,...] where each option
+// is rom, ram or a symbol definition.
+std::optional<Job> parseConfiguration(
+    std::string_view configuration,
+    const Job& base,
+    std::ostream& errors
+) {
+    Job job{base};
+
+    auto colon = configuration.find(':');
+    job.outfile = configuration.substr(0, colon);
+    job.name = job.outfile;
+    if (job.outfile.empty()) {
+        errors << "configuration '" << configuration << "' has no output file\n";
+        return std::nullopt;
+    }
+
+    if (colon == std::string_view::npos) {
+        return job;
+    }
+
+    std::string_view options = configuration.substr(colon + 1);
+    while (!options.empty()) {
+        auto comma = options.find(',');
+        std::string_view option = options.substr(0, comma);
+        options = comma == std::string_view::npos
+            ? std::string_view{}
+            : options.substr(comma + 1);
+
+        if (option == "rom") {
+            job.sectionMode = SectionMode::ROM;
+        } else if (option == "ram") {
+            job.sectionMode = SectionMode::RAM;
+        } else if (!parseDefinition(option, job.definitions, errors)) {
+            return std::nullopt;
+        }
+    }
+    return job;
+}
+
+// Assembles every job in parallel, sharing parsed files between them.
+// Diagnostics are printed per job in the order given.
+bool assembleJobs(
+    const std::vector<Job>& jobs,
+    const std::vector<std::string>& includePath,
+    const std::optional<std::string>& prelude,
+    bool printSymbols,
+    int threads,
+    const OutputCache* outputCache,
+    const std::vector<const SymbolDatabase*>& symbolDatabases,
+    std::ostream& errors
+) {
+    const InstructionSet instructionSet{};
+    ParseCache parseCache{includePath};
+
+    std::vector<std::stringstream> diagnostics(jobs.size());
+    std::vector<char> results(jobs.size(), false);
+
+    std::vector<std::function<void()>> tasks{};
+    for (std::size_t i = 0; i < jobs.size(); ++i) {
+        tasks.push_back([&, i]() {
+            try {
+                Assembler assembler{
+                    jobs[i].sectionMode,
+                    instructionSet,
+                    parseCache,
+                    prelude
+                };
+                assembler.setDefinitions(jobs[i].definitions);
+                assembler.setSymbolDatabases(symbolDatabases);
+                assembler.setRelocatable(jobs[i].relocatable);
+                assembler.setRoutineElimination(
+                    jobs[i].eliminateRoutines,
+                    jobs[i].entryPoints
+                );
+                results[i] = assembleTo(
+                    assembler,
+                    jobs[i].infile,
+                    jobs[i].outfile,
+                    printSymbols,
+                    diagnostics[i],
+                    diagnostics[i],
+                    outputCache
+                );
+            } catch (const std::exception& error) {
+                // Anything escaping a worker thread would terminate, so it
+                // fails the job instead.
+                diagnostics[i] << error.what() << '\n';
+                results[i] = false;
+            }
+        });
+    }
+
+    runParallel(
+        std::move(tasks),
+        threads > 0 ? threads : std::thread::hardware_concurrency()
+    );
+
+    bool success = true;
+    for (std::size_t i = 0; i < jobs.size(); ++i) {
+        std::string text = diagnostics[i].str();
+        if (!text.empty()) {
+            errors << jobs[i].name << ":\n" << text;
+        }
+        success = success && results[i];
+    }
+    return success;
+}
+
+int runCommand(
+    int argc,
+    char** argv,
+    std::ostream& output,
+    std::ostream& errors,
+    AssemblerCache* cache
+) {
+    enum class Action {
+        assemble,
+        help,
+        version,
+        server,
+        languageServer,
+        link,
+    };
+
+    Action action = Action::assemble;
+
+    std::string outfile{};
+    std::string infile = "stdin";
+    std::string depfile{};
+    std::string exportSymbols{};
+    std::vector<std::string> importArgs{};
+    bool timeReport = false;
+    std::string traceFile{};
+    bool memReport = false;
+    bool streaming = false;
+    std::string listingPath{};
+    bool printSymbols = false;
+    bool watch = false;
+    bool batch = false;
+    bool relocatable = false;
+    bool eliminateRoutines = false;
+    std::vector<std::string> entryArgs{};
+    int jobs = 0;
+    std::vector<std::string> files{};
+    std::vector<std::string> definitionArgs{};
+    std::vector<std::string> configurations{};
+    std::vector<std::string> includePath{};
+    SectionMode sectionMode = SectionMode::ROM;
+    std::optional<std::string> prelude{};
+    std::string socketPath{};
+    std::optional<std::string> connect{};
+    std::string cacheDir{};
+
+    // A served command gets the client's environment as arguments.
+    if (!cache) {
+        const char* env_prelude = std::getenv("ASPDR_PRELUDE");
+        if (env_prelude) {
+            prelude = env_prelude;
+        }
+
+        const char* env_include = std::getenv("ASPDR_INCLUDE");
+        if (env_include) {
+            includePath.push_back(env_include);
+        }
+
+        const char* env_cache_dir = std::getenv("ASPDR_CACHE_DIR");
+        if (env_cache_dir) {
+            cacheDir = env_cache_dir;
+        }
+    }
+
+    ArgumentParser argumentParser{argc, argv, errors};
+    if (!argumentParser
+        .addOpt('o', "outfile", argumentString(&outfile))
+        .addOpt('M', "depfile", argumentString(&depfile))
+        .addOpt('s', "symbols", argumentAssign(&printSymbols, true))
+        .addOpt({}, "export-symbols", argumentString(&exportSymbols))
+        .addOpt({}, "import-symbols", argumentAppendString(&importArgs))
+        .addOpt({}, "time-report", argumentAssign(&timeReport, true))
+        .addOpt({}, "trace", argumentString(&traceFile))
+        .addOpt({}, "mem-report", argumentAssign(&memReport, true))
+        .addOpt({}, "stream", argumentAssign(&streaming, true),
+            "Drop each included file's syntax tree once it is assembled. A "
+            "single large file is still held whole while it is assembled.")
+        .addOpt({}, "listing", argumentString(&listingPath))
+        .addOpt('i', "include", argumentAppendString(&includePath))
+        .addOpt('p', "prelude", argumentString(&prelude))
+        .addOpt('r', "ram", argumentAssign(&sectionMode, SectionMode::RAM))
+        .addOpt({}, "rom", argumentAssign(&sectionMode, SectionMode::ROM))
+        .addOpt({}, "server", [&](const char* value) {
+            socketPath = value;
+            action = Action::server;
+            return true;
+        })
+        .addOpt({}, "connect", argumentString(&connect))
+        .addOpt({}, "lsp", argumentAssign(&action, Action::languageServer))
+        .addOpt({}, "object", argumentAssign(&relocatable, true))
+        .addOpt({}, "gc-routines", argumentAssign(&eliminateRoutines, true))
+        .addOpt('e', "entry", argumentAppendString(&entryArgs))
+        .addOpt({}, "link", argumentAssign(&action, Action::link))
+        .addOpt({}, "cache-dir", argumentString(&cacheDir))
+        .addOpt({}, "watch", argumentAssign(&watch, true))
+        .addOpt('b', "batch", argumentAssign(&batch, true))
+        .addOpt('j', "jobs", argumentInt(&jobs))
+        .addOpt('D', "define", argumentAppendString(&definitionArgs))
+        .addOpt('c', "config", argumentAppendString(&configurations))
+        .addOpt('h', "help", argumentAssign(&action, Action::help))
+        .addOpt('v', "version", argumentAssign(&action, Action::version))
+        .setDefaultArg(argumentAppendString(&files))
+        .parse()
+    ) {
+        return 2;
+    }
+
+    if (!files.empty()) {
+        infile = files.back();
+    }
+
+    Definitions definitions{};
+    for (const auto& definition : definitionArgs) {
+        if (!parseDefinition(definition, definitions, errors)) {
+            return 2;
+        }
+    }
+
+    std::set<std::string> entryPoints{entryArgs.begin(), entryArgs.end()};
+
+    if (!depfile.empty() && (outfile.empty() || batch || !configurations.empty())) {
+        errors << "--depfile requires --outfile and a single build\n";
+        return 2;
+    }
+
+    if (!exportSymbols.empty()
+        && (batch || !configurations.empty() || relocatable)
+    ) {
+        errors << "--export-symbols requires a single image build\n";
+        return 2;
+    }
+
+    bool profiling = timeReport || !traceFile.empty();
+    if ((profiling || memReport) && (batch || !configurations.empty() || watch)) {
+        errors << "--time-report, --trace and --mem-report require a single build\n";
+        return 2;
+    }
+
+    // Streaming rewinds statement ids, which jobs on other threads share.
+    if (streaming && (batch || !configurations.empty())) {
+        errors << "--stream requires a single build\n";
+        return 2;
+    }
+
+    if (!listingPath.empty() && (batch || !configurations.empty() || watch)) {
+        errors << "--listing requires a single build\n";
+        return 2;
+    }
+
+    std::vector<SymbolDatabase> databaseStorage{};
+    std::vector<const SymbolDatabase*> symbolDatabases{};
+    if (!openSymbolDatabases(importArgs, databaseStorage, symbolDatabases, errors)) {
+        return 1;
+    }
+
+    // A cached build has no symbols to export, time and memory to report or
+    // lines to list, so it is not used then.
+    std::optional<OutputCache> cacheStorage{};
+    if (!cacheDir.empty()
+        && exportSymbols.empty()
+        && !profiling
+        && !memReport
+        && listingPath.empty()
+    ) {
+        cacheStorage.emplace(cacheDir);
+    }
+    const OutputCache* outputCache = cacheStorage ? &*cacheStorage : nullptr;
+
+    std::optional<Profiler> profiler{};
+    if (profiling) {
+        profiler.emplace(!traceFile.empty());
+    }
+
+    std::optional<MemoryReport> memoryReport{};
+    if (memReport) {
+        memoryReport.emplace();
+    }
+
+    // Listings of full images run long, so they are written through a
+    // larger buffer than the default.
+    std::vector<char> listingBuffer{};
+    std::ofstream listingFile{};
+    if (!listingPath.empty()) {
+        listingBuffer.resize(1 << 16);
+        listingFile.rdbuf()->pubsetbuf(listingBuffer.data(), listingBuffer.size());
+        listingFile.open(listingPath);
+        if (!listingFile) {
+            errors << "failed to open '" << listingPath << "'\n";
+            return 1;
+        }
+    }
+    std::ostream* listing = listingPath.empty() ? nullptr : &listingFile;
+
+    bool success = true;
+
+    switch (action) {
+        case Action::assemble:
+        {
+            if (connect && !cache && infile != "stdin") {
+                auto status = runClient(*connect, argc, argv, output, errors);
+                if (status) {
+                    return *status;
+                }
+            }
+
+            if (batch) {
+                if (files.empty() || files.size() % 2 != 0) {
+                    errors << "--batch requires pairs of input and output files\n";
+                    return 2;
+                }
+
+                std::vector<Job> batchJobs{};
+                for (std::size_t i = 0; i < files.size(); i += 2) {
+                    batchJobs.push_back({
+                        files[i], files[i], files[i + 1], sectionMode, definitions,
+                        relocatable, eliminateRoutines, entryPoints
+                    });
+                }
+
+                success = assembleJobs(
+                    batchJobs, includePath, prelude, printSymbols, jobs,
+                    outputCache, symbolDatabases, errors
+                );
+                break;
+            }
+
+            if (!configurations.empty()) {
+                Job base{
+                    infile, infile, outfile, sectionMode, definitions,
+                    relocatable, eliminateRoutines, entryPoints
+                };
+                std::vector<Job> matrixJobs{};
+                for (const auto& configuration : configurations) {
+                    auto job = parseConfiguration(configuration, base, errors);
+                    if (!job) {
+                        return 2;
+                    }
+                    matrixJobs.push_back(*job);
+                }
+
+                success = assembleJobs(
+                    matrixJobs, includePath, prelude, printSymbols, jobs,
+                    outputCache, symbolDatabases, errors
+                );
+                break;
+            }
+
+            if (cache) {
+                Assembler& assembler = cache->get(
+                    sectionMode,
+                    includePath,
+                    prelude
+                );
+                assembler.parseCache.refresh();
+                assembler.parseCache.setStreaming(streaming);
+                assembler.setDefinitions(definitions);
+                assembler.setSymbolDatabases(symbolDatabases);
+                assembler.setRelocatable(relocatable);
+                assembler.setRoutineElimination(eliminateRoutines, entryPoints);
+                assembler.setProfiler(profiler ? &*profiler : nullptr);
+                assembler.setMemoryReport(memoryReport ? &*memoryReport : nullptr);
+                assembler.setListing(listing);
+
+                success = assembleTo(
+                    assembler, infile, outfile, printSymbols, output, errors,
+                    outputCache
+                );
+                if (success && !depfile.empty()) {
+                    success = writeDepfile(assembler, depfile, outfile, errors);
+                }
+                if (success && !exportSymbols.empty()) {
+                    success = writeSymbolDatabase(assembler, exportSymbols, errors);
+                }
+                if (profiler) {
+                    success = writeProfile(*profiler, timeReport, traceFile, errors)
+                        && success;
+                }
+                if (memoryReport) {
+                    memoryReport->write(errors);
+                }
+                if (listing) {
+                    success = writeListingFile(listingFile, listingPath, errors)
+                        && success;
+                }
+
+                // The databases and reports go when this command returns.
+                assembler.setSymbolDatabases({});
+                assembler.setProfiler(nullptr);
+                assembler.setMemoryReport(nullptr);
+                assembler.setListing(nullptr);
+                assembler.parseCache.setStreaming(false);
+                break;
+            }
+
+            const InstructionSet instructionSet{};
+            ParseCache parseCache{includePath};
+            parseCache.setStreaming(streaming);
+            Assembler assembler{sectionMode, instructionSet, parseCache, prelude};
+            assembler.setDefinitions(definitions);
+            assembler.setSymbolDatabases(symbolDatabases);
+            assembler.setRelocatable(relocatable);
+            assembler.setRoutineElimination(eliminateRoutines, entryPoints);
+            assembler.setProfiler(profiler ? &*profiler : nullptr);
+            assembler.setMemoryReport(memoryReport ? &*memoryReport : nullptr);
+            assembler.setListing(listing);
+
+            if (watch) {
+                if (outfile.empty() || infile == "stdin") {
+                    errors << "--watch requires an input file and --outfile\n";
+                    return 2;
+                }
+
+                // Databases are mapped again for each build, since they are
+                // replaced by renaming when exported.
+                return runWatch(parseCache, importArgs, [&]() {
+                    bool opened = openSymbolDatabases(
+                        importArgs, databaseStorage, symbolDatabases, errors
+                    );
+                    assembler.setSymbolDatabases(symbolDatabases);
+                    if (!opened) {
+                        return;
+                    }
+
+                    if (assembleTo(
+                        assembler, infile, outfile, printSymbols, output, errors,
+                        outputCache
+                    ) && (depfile.empty()
+                        || writeDepfile(assembler, depfile, outfile, errors))
+                    && (exportSymbols.empty()
+                        || writeSymbolDatabase(assembler, exportSymbols, errors))
+                    ) {
+                        errors << "wrote '" << outfile << "'\n";
+                    }
+                }, errors);
+            }
+
+            success = assembleTo(
+                assembler, infile, outfile, printSymbols, output, errors,
+                outputCache
+            );
+            if (success && !depfile.empty()) {
+                success = writeDepfile(assembler, depfile, outfile, errors);
+            }
+            if (success && !exportSymbols.empty()) {
+                success = writeSymbolDatabase(assembler, exportSymbols, errors);
+            }
+            if (profiler) {
+                success = writeProfile(*profiler, timeReport, traceFile, errors)
+                    && success;
+            }
+            if (memoryReport) {
+                memoryReport->write(errors);
+            }
+            if (listing) {
+                success = writeListingFile(listingFile, listingPath, errors)
+                    && success;
+            }
+        }
+            break;
+        case Action::link:
+        {
+            if (files.empty()) {
+                errors << "--link requires object files\n";
+                return 2;
+            }
+
+            std::vector<ObjectFile> objects{};
+            for (const auto& file : files) {
+                std::ifstream stream{file, std::ios::binary};
+                auto object = ObjectFile::read(stream);
+                if (!object) {
+                    errors << "'" << file << "' is not an object file\n";
+                    return 1;
+                }
+                objects.push_back(std::move(*object));
+            }
+
+            const InstructionSet instructionSet{};
+            ParseCache parseCache{includePath};
+            Assembler assembler{sectionMode, instructionSet, parseCache, prelude};
+            assembler.setSymbolDatabases(symbolDatabases);
+
+            std::stringstream image{};
+            success = assembler.link(objects, files, image, errors)
+                && writeImage(image.str(), outfile, output, errors);
+
+            if (printSymbols) {
+                assembler.printSymbols(errors);
+            }
+        }
+            break;
+        case Action::help:
+            argumentParser.printHelp(errors);
+            break;
+        case Action::version:
+            argumentParser.printVersion(errors, "");
+            break;
+        case Action::server:
+            if (cache) {
+                errors << "cannot start a server from a client\n";
+                return 2;
+            }
+            return runServer(socketPath, errors);
+        case Action::languageServer:
+        {
+            if (cache) {
+                errors << "cannot start a language server from a client\n";
+                return 2;
+            }
+
+            LanguageServer server{
+                sectionMode, includePath, prelude, definitions, files,
+                output, errors
+            };
+            return server.run(STDIN_FILENO);
+        }
+    }
+
+    return success ? 0 : 1;
+}
+
@@ -0,0 +1,20 @@
+#ifndef COMMAND_HPP
+#define COMMAND_HPP
+
+#include <iostream>
+
+class AssemblerCache;
+
+// Runs the assembler as invoked from the command line. When `cache` is
+// given the command is being served for a client and reuses its
+// assemblers instead of creating new ones.
+int runCommand(
+    int argc,
+    char** argv,
+    std::ostream& output,
+    std::ostream& errors,
+    AssemblerCache* cache = nullptr
+);
+
+#endif
+
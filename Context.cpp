@@ -6,15 +6,71 @@ Context::Context(Assembler* assembler)
     sections{},
     currentSection{"code"},
     includedFiles{},
+    dependencies{},
+    dependencyHashes{},
     fileNames{},
     frames{},
-    scope{}
+    scope{},
+    symbolLocations{},
+    labels{},
+    profiler{assembler->getProfiler()},
+    profile{nullptr},
+    listing{assembler->getListing() != nullptr},
+    listingLines{},
+    cycleBudgets{},
+    relocationBases{},
+    relocationShifts{},
+    relocations{},
+    unresolved{},
+    currentRoutine{},
+    inOperand{false},
+    discarding{false},
+    routineStarts{},
+    routineReferences{},
+    fixedRoutines{},
+    layoutOffsets{},
+    fixingRoutine{false}
 {
     for (auto& sec : assembler->sections) {
         sections[sec.first] = Section{&sec.second};
     }
 }
 
+void Context::reset() {
+    this->clearErrors();
+
+    for (auto& section : this->sections) {
+        section.second.reset();
+    }
+    this->currentSection = "code";
+    this->includedFiles.clear();
+    this->dependencies.clear();
+    this->dependencyHashes.clear();
+    this->fileNames.clear();
+    this->macros.clear();
+    this->frames.clear();
+    this->scope = Identifier{};
+    this->symbolLocations.clear();
+    this->labels.clear();
+    this->profile = nullptr;
+    this->listingLines.clear();
+    this->cycleBudgets.clear();
+
+    this->relocationBases.clear();
+    this->relocationShifts.clear();
+    this->relocations.clear();
+    this->unresolved.clear();
+
+    this->currentRoutine.reset();
+    this->inOperand = false;
+    this->discarding = false;
+    this->routineStarts.clear();
+    this->routineReferences.clear();
+    this->fixedRoutines.clear();
+    this->layoutOffsets.clear();
+    this->fixingRoutine = false;
+}
+
 Section& Context::getSection() {
     return sections[currentSection];
 }
@@ -78,3 +134,65 @@ bool Context::addMacro(MacroStatement* macro) {
     return true;
 }
 
+
+std::optional<Relocation> Context::getRelocation(
+    const Expression* expr,
+    std::int64_t value
+) {
+    if (this->relocationBases.empty()) {
+        return std::nullopt;
+    }
+
+    // Evaluating again with one base moved at a time shows which bases the
+    // value follows. Shifting by two amounts catches masks and shifts.
+    const std::int64_t deltas[] = {1, 0x10000};
+    std::set<RelocationBase> bases{std::move(this->relocationBases)};
+    ErrorMark errorMark = this->markErrors();
+
+    std::optional<RelocationBase> found{};
+    bool relocatable = true;
+
+    for (const auto& base : bases) {
+        int moves = 0;
+        for (auto delta : deltas) {
+            this->relocationShifts[base] = delta;
+            auto shifted = expr->evaluate(*this);
+            this->relocationShifts.clear();
+
+            if (shifted && *shifted - value == delta) {
+                ++moves;
+            } else if (!shifted || *shifted != value) {
+                relocatable = false;
+            }
+        }
+
+        if (moves == 1 || (moves == 2 && found)) {
+            relocatable = false;
+        } else if (moves == 2) {
+            found = base;
+        }
+    }
+
+    this->restoreErrors(errorMark);
+    this->relocationBases.clear();
+
+    if (!relocatable) {
+        this->error(
+            Error::Level::Fatal,
+            "expression is not relocatable",
+            expr->location
+        );
+        return std::nullopt;
+    }
+
+    if (!found) {
+        return std::nullopt;
+    }
+
+    Relocation relocation{};
+    relocation.base = *found;
+    relocation.addend = found->external
+        ? value
+        : value - this->assembler->sections.at(found->name).start;
+    return relocation;
+}
@@ -7,6 +7,8 @@
 #include "Assembler.hpp"
 #include "Frame.hpp"
 #include "MacroStatement.hpp"
+#include "ObjectFile.hpp"
+#include "Listing.hpp"
 #include <map>
 #include <string>
 #include <set>
@@ -21,7 +23,12 @@ public:
     std::map<std::string, Section> sections;
     std::string currentSection;
     std::set<std::string> includedFiles;
+    std::set<std::string> dependencies;
 
+    // Hash of each dependency's contents as it was parsed.
+    std::map<std::string, std::size_t> dependencyHashes;
+
+    // Files being assembled, outermost first.
     std::vector<std::string> fileNames;
     std::map<Instruction, MacroStatement*> macros;
 
@@ -29,8 +36,56 @@ public:
 
     Identifier scope;
 
+    // Where each symbol was first assigned, and which symbols are labels,
+    // for tools which navigate the source.
+    std::map<Identifier, Location> symbolLocations;
+    std::set<Identifier> labels;
+
+    // Profiling only, null otherwise. The profile counts what this pass
+    // does.
+    Profiler* profiler;
+    PassProfile* profile;
+
+    // Listing, or cycle budgets, only. What each statement of this pass
+    // wrote.
+    bool listing;
+    std::vector<ListingLine> listingLines;
+
+    // Regions asserted to run within a number of cycles.
+    std::vector<CycleBudget> cycleBudgets;
+
+    // Relocatable assembly only. Symbol evaluation records the bases it
+    // used and adds the shift of each base to its value.
+    std::set<RelocationBase> relocationBases;
+    std::map<RelocationBase, std::int64_t> relocationShifts;
+    std::vector<Relocation> relocations;
+    std::set<Identifier> unresolved;
+
+    // Routine elimination only. Top level labels in the code section start
+    // routines, and operands name the routines they reference. References
+    // made anywhere else are recorded under the empty name.
+    std::optional<std::string> currentRoutine;
+    bool inOperand;
+    bool discarding;
+    std::vector<std::pair<std::string, std::int64_t>> routineStarts;
+    std::map<std::string, std::set<std::string>> routineReferences;
+    std::set<std::string> fixedRoutines;
+
+    // Where `address` and `align` directives pad the code, in order.
+    std::vector<std::int64_t> layoutOffsets;
+
+    // Set by an `address` directive in the code section, so that the next
+    // routine, which starts at the fixed address, is kept.
+    bool fixingRoutine;
+
     Context(Assembler* assembler);
 
+    // Forgets everything assembled for the start of another pass. Section
+    // images, the error list and the other vectors keep their capacity, so
+    // later passes do not grow them again. The maps and sets free their
+    // nodes, which each pass allocates afresh.
+    void reset();
+
     virtual std::vector<Error>& getErrors() override;
     virtual const std::vector<Error>& getErrors() const override;
 
@@ -52,6 +107,13 @@ public:
     bool markAsIncluded(const std::string& fileName);
 
     bool addMacro(MacroStatement* macro);
+
+    // Finds the base `value`, the result of evaluating `expr`, moves with.
+    // Returns nullopt if the value is absolute.
+    std::optional<Relocation> getRelocation(
+        const Expression* expr,
+        std::int64_t value
+    );
 };
 
 #endif
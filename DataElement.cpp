@@ -22,6 +22,31 @@ bool ExpressionElement::write(Context& context, int defaultSize) {
         .writeInteger(context, this->expression, defaultSize);
 }
 
+bool ExpressionElement::isIterationInvariant() const {
+    return this->expression->isIterationInvariant();
+}
+
+bool ExpressionElement::pack(std::vector<char>& bytes, int defaultSize) const {
+    auto value = this->expression->getConstant();
+    if (!value) {
+        return false;
+    }
+
+    if (this->size) {
+        defaultSize = *this->size;
+    }
+
+    for (int i = 0; i < defaultSize; ++i) {
+        bytes.push_back((*value >> (i * 8)) & 0xff);
+    }
+    return true;
+}
+
+void ExpressionElement::addMemoryUsage(MemoryTallies& usage) const {
+    usage["ExpressionElement"].add(sizeof(*this));
+    this->expression->addMemoryUsage(usage);
+}
+
 ExpressionElement::~ExpressionElement() {
     delete this->expression;
 }
@@ -37,3 +62,82 @@ bool StringElement::write(Context& context, int defaultSize) {
     return context.getSection().writeBytes(context, this->location, this->data);
 }
 
+bool StringElement::isIterationInvariant() const {
+    return true;
+}
+
+bool StringElement::pack(std::vector<char>& bytes, int defaultSize) const {
+    bytes.insert(bytes.end(), this->data.begin(), this->data.end());
+    return true;
+}
+
+void StringElement::addMemoryUsage(MemoryTallies& usage) const {
+    usage["StringElement"].add(sizeof(*this) + getHeapSize(this->data));
+}
+
+
+IntegerListElement::IntegerListElement(
+    Location location,
+    std::vector<std::int64_t> values
+) : DataElement{location}, values{values} {}
+
+bool IntegerListElement::write(Context& context, int defaultSize) {
+    return context.getSection().writeIntegers(
+        context,
+        this->location,
+        this->values,
+        defaultSize
+    );
+}
+
+bool IntegerListElement::isIterationInvariant() const {
+    return true;
+}
+
+bool IntegerListElement::pack(std::vector<char>& bytes, int defaultSize) const {
+    bytes.reserve(bytes.size() + this->values.size() * defaultSize);
+    for (auto value : this->values) {
+        for (int i = 0; i < defaultSize; ++i) {
+            bytes.push_back((value >> (i * 8)) & 0xff);
+        }
+    }
+    return true;
+}
+
+void IntegerListElement::addMemoryUsage(MemoryTallies& usage) const {
+    usage["IntegerListElement"].add(sizeof(*this) + getHeapSize(this->values));
+}
+
+
+std::vector<DataElement*> packElements(
+    const std::vector<DataElement*>& elements,
+    int defaultSize
+) {
+    std::vector<DataElement*> packed{};
+    std::vector<char> bytes{};
+    std::optional<Location> runLocation{};
+
+    auto flush = [&]() {
+        if (runLocation) {
+            packed.push_back(new StringElement{*runLocation, std::move(bytes)});
+            bytes = {};
+            runLocation = std::nullopt;
+        }
+    };
+
+    for (auto elem : elements) {
+        if (elem->pack(bytes, defaultSize)) {
+            if (!runLocation) {
+                runLocation = elem->location;
+            }
+            delete elem;
+            continue;
+        }
+
+        flush();
+        packed.push_back(elem);
+    }
+    flush();
+
+    return packed;
+}
@@ -3,6 +3,7 @@
 
 #include "Location.hpp"
 #include "Expression.hpp"
+#include <cstdint>
 #include <vector>
 #include <string>
 #include <optional>
@@ -16,6 +17,13 @@ public:
     DataElement(Location location);
 
     virtual bool write(Context& context, int defaultSize) = 0;
+    virtual bool isIterationInvariant() const = 0;
+
+    // Appends the encoded element to `bytes` if it is known at parse time.
+    virtual bool pack(std::vector<char>& bytes, int defaultSize) const = 0;
+
+    // Adds the element and what it owns to `usage`, by class.
+    virtual void addMemoryUsage(MemoryTallies& usage) const = 0;
 
     virtual ~DataElement();
 };
@@ -28,6 +36,9 @@ public:
     ExpressionElement(Location location, Expression* expr, std::optional<int> size = {});
 
     virtual bool write(Context& context, int defaultSize) override;
+    virtual bool isIterationInvariant() const override;
+    virtual bool pack(std::vector<char>& bytes, int defaultSize) const override;
+    virtual void addMemoryUsage(MemoryTallies& usage) const override;
 
     virtual ~ExpressionElement() override;
 };
@@ -40,7 +51,29 @@ public:
     StringElement(Location location, std::vector<char> data);
 
     virtual bool write(Context& context, int defaultSize) override;
+    virtual bool isIterationInvariant() const override;
+    virtual bool pack(std::vector<char>& bytes, int defaultSize) const override;
+    virtual void addMemoryUsage(MemoryTallies& usage) const override;
 };
 
+class IntegerListElement : public DataElement {
+public:
+    std::vector<std::int64_t> values;
+
+    IntegerListElement(Location location, std::vector<std::int64_t> values);
+
+    virtual bool write(Context& context, int defaultSize) override;
+    virtual bool isIterationInvariant() const override;
+    virtual bool pack(std::vector<char>& bytes, int defaultSize) const override;
+    virtual void addMemoryUsage(MemoryTallies& usage) const override;
+};
+
+// Replaces runs of constant elements with a single StringElement holding
+// their encoded bytes.
+std::vector<DataElement*> packElements(
+    const std::vector<DataElement*>& elements,
+    int defaultSize
+);
+
 #endif
 
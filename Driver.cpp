@@ -3,7 +3,7 @@
 
 Driver::Driver(
     const std::string& fileName
-) : location{&fileName}, reachedEof{false} {
+) : location{&fileName}, reachedEof{false}, errors{} {
     parsed = new Block{};
 }
 
@@ -4,7 +4,9 @@
 #include "Statement.hpp"
 #include "parser.hpp"
 #include "Block.hpp"
+#include "Error.hpp"
 #include <string>
+#include <vector>
 
 #define YY_DECL \
     yy::parser::symbol_type yylex(Driver& driver)
@@ -15,6 +17,7 @@ public:
     yy::location location;
     bool reachedEof;
     Block* parsed;
+    std::vector<Error> errors;
     //std::unique_ptr<ParsedFile> parsed;
 
     Driver(const std::string& fileName);
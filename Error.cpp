@@ -1,4 +1,5 @@
 #include "Error.hpp"
+#include "Identifier.hpp"
 
 AssemblerError::AssemblerError(std::string message) : message{message} {
 }
@@ -8,16 +9,52 @@ const char* AssemblerError::what() const noexcept {
 }
 
 Error::Error(Error::Level level, std::optional<Location> location, std::string message)
-: level{level}, location{location}, message{message} {}
+:   level{level},
+    code{Error::Code::Message},
+    location{location},
+    message{message},
+    identifier{} {}
 
 Error::Error(Error::Level level, std::string message)
-: level{level}, location{std::nullopt}, message{message} {}
+: Error{level, std::nullopt, message} {}
+
+Error::Error(
+    Error::Level level,
+    Error::Code code,
+    std::optional<Location> location,
+    UnqualifiedIdentifier identifier
+)
+:   level{level},
+    code{code},
+    location{location},
+    message{},
+    identifier{std::move(identifier)} {}
+
+std::string Error::getMessage() const {
+    switch (this->code) {
+        case Error::Code::Message:
+            return this->message;
+        case Error::Code::UnresolvedSymbol:
+        {
+            std::stringstream ss{};
+            ss << "cannot resolve symbol \'" << this->identifier << "\'";
+            return ss.str();
+        }
+        case Error::Code::UnknownAddress:
+            return "cannot get address";
+    }
+    UNREACHABLE;
+}
 
 void Error::display() {
     std::clog << *this << '\n';
 }
 
 bool Error::operator==(const Error& other) const {
+    if (this->code != other.code
+        || this->identifier.depth != other.identifier.depth
+        || (this->identifier.identifier <=> other.identifier.identifier) != 0)
+        return false;
     if (this->location && other.location)
         return *this->location == *other.location;
     if (this->location || other.location)
@@ -26,7 +63,7 @@ bool Error::operator==(const Error& other) const {
 }
 
 std::ostream& operator<<(std::ostream& stream, const Error& error) {
-    printError(stream, error.message, error.location);
+    printError(stream, error.getMessage(), error.location);
     return stream;
 }
 
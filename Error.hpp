@@ -2,6 +2,7 @@
 #define ERROR_HPP
 
 #include "Location.hpp"
+#include "Identifier.hpp"
 #include <exception>
 #include <optional>
 #include <iostream>
@@ -41,12 +42,33 @@ public:
         Syntax,
     };
 
+    // Errors raised on every pass are recorded by code and only formatted
+    // when displayed.
+    enum class Code {
+        Message,
+        UnresolvedSymbol,
+        UnknownAddress,
+    };
+
     Error::Level level;
+    Error::Code code;
     std::optional<Location> location;
     std::string message;
 
+    // Held by value, since the statement which raised the error may be
+    // released before the error is displayed.
+    UnqualifiedIdentifier identifier;
+
     Error(Error::Level level, std::optional<Location> location, std::string message);
     Error(Error::Level level, std::string message);
+    Error(
+        Error::Level level,
+        Error::Code code,
+        std::optional<Location> location,
+        UnqualifiedIdentifier identifier = {}
+    );
+
+    std::string getMessage() const;
 
     void display();
 
@@ -1,8 +1,32 @@
 #include "ErrorHandler.hpp"
 #include <algorithm>
+#include <format>
+
+ErrorHandler::ErrorHandler() : passErrors{0}, suppressedErrors{0} {}
+
+void ErrorHandler::clearErrors() {
+    this->getErrors().clear();
+    this->passErrors = 0;
+    this->suppressedErrors = 0;
+}
+
+ErrorMark ErrorHandler::markErrors() const {
+    return {this->getErrors().size(), this->passErrors, this->suppressedErrors};
+}
+
+void ErrorHandler::restoreErrors(const ErrorMark& mark) {
+    auto& errors = this->getErrors();
+    errors.erase(errors.begin() + mark.errors, errors.end());
+    this->passErrors = mark.passErrors;
+    this->suppressedErrors = mark.suppressedErrors;
+}
 
 bool ErrorHandler::hasErrors() const {
-    return this->getErrors().size() > 0;
+    return this->getErrors().size() > 0 || this->suppressedErrors > 0;
+}
+
+std::size_t ErrorHandler::getSuppressedErrors() const {
+    return this->suppressedErrors;
 }
 
 bool ErrorHandler::hasErrorLevel(Error::Level level) const {
@@ -16,11 +40,25 @@ bool ErrorHandler::hasErrorLevel(Error::Level level) const {
 
 void ErrorHandler::displayErrors(std::ostream& stream) {
     for (const auto& err : this->getErrors()) {
-        std::clog << err;
+        stream << err;
+    }
+
+    if (this->suppressedErrors > 0) {
+        printError(
+            stream,
+            std::format("{} more errors not shown", this->suppressedErrors)
+        );
     }
 }
 
 void ErrorHandler::error(const Error& err) {
+    if (err.level == Error::Level::Pass) {
+        if (this->passErrors >= ErrorHandler::maxPassErrors) {
+            ++this->suppressedErrors;
+            return;
+        }
+        ++this->passErrors;
+    }
     this->getErrors().push_back(err);
 }
 
@@ -6,16 +6,42 @@
 #include <iostream>
 #include <optional>
 
+// How many errors a handler had, to drop those raised after it.
+class ErrorMark {
+public:
+    std::size_t errors;
+    std::size_t passErrors;
+    std::size_t suppressedErrors;
+};
+
 class ErrorHandler {
+private:
+    std::size_t passErrors;
+    std::size_t suppressedErrors;
+
 public:
+    // Pass errors beyond this are only counted.
+    static constexpr std::size_t maxPassErrors = 64;
+
+    ErrorHandler();
+
     virtual std::vector<Error>& getErrors() = 0;
     virtual const std::vector<Error>& getErrors() const = 0;
 
+    // Drops every error, including suppressed ones.
+    void clearErrors();
+
+    ErrorMark markErrors() const;
+
+    // Drops the errors raised since `mark`, as if they had not been.
+    void restoreErrors(const ErrorMark& mark);
+
     void error(const Error& err);
 
     void error(Error::Level level, std::string message, std::optional<Location> location = {});
 
     bool hasErrors() const;
+    std::size_t getSuppressedErrors() const;
     bool hasErrorLevel(Error::Level level) const;
 
     void displayErrors(std::ostream& stream);
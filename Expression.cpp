@@ -2,7 +2,17 @@
 #include "Error.hpp"
 #include "Assembler.hpp"
 #include "Context.hpp"
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <format>
+#include <map>
+#include <numbers>
 #include <sstream>
+#include <tuple>
+
+TableIndex::TableIndex(std::string name, std::vector<std::int64_t> values)
+: name{name}, values{values} {}
 
 Expression::Expression(Location location) : location{location} {
 }
@@ -32,6 +42,34 @@ std::optional<std::int64_t> Expression::mustEvaluate(Context& context) const {
     return value;
 }
 
+std::optional<std::int64_t> Expression::getConstant() const {
+    return std::nullopt;
+}
+
+bool Expression::evaluateTable(
+    Context& context,
+    const TableIndex& index,
+    std::vector<std::int64_t>& values
+) const {
+    auto value = this->evaluate(context);
+    if (!value) {
+        return false;
+    }
+    values.assign(index.values.size(), *value);
+    return true;
+}
+
+template<typename F>
+void applyTable(
+    std::vector<std::int64_t>& x,
+    const std::vector<std::int64_t>& y,
+    F function
+) {
+    for (std::size_t i = 0; i < x.size(); ++i) {
+        x[i] = function(x[i], y[i]);
+    }
+}
+
 std::optional<std::int64_t> BinaryExpression::performOperation(
     Context& context,
     std::int64_t x,
@@ -91,6 +129,9 @@ std::optional<std::int64_t> BinaryExpression::performOperation(
 }
 
 std::optional<std::int64_t> BinaryExpression::evaluate(Context& context) const {
+    if (context.profile) {
+        ++context.profile->evaluations;
+    }
     auto r0 = this->operand0->evaluate(context);
     auto r1 = this->operand1->evaluate(context);
     if (!(r0.has_value() && r1.has_value())) {
@@ -99,6 +140,97 @@ std::optional<std::int64_t> BinaryExpression::evaluate(Context& context) const {
     return this->performOperation(context, *r0, *r1);
 }
 
+bool BinaryExpression::evaluateTable(
+    Context& context,
+    const TableIndex& index,
+    std::vector<std::int64_t>& values
+) const {
+    std::vector<std::int64_t> y{};
+    bool r0 = this->operand0->evaluateTable(context, index, values);
+    bool r1 = this->operand1->evaluateTable(context, index, y);
+    if (!(r0 && r1)) {
+        return false;
+    }
+
+    using V = std::int64_t;
+    switch (operation) {
+        case Binary::Add:
+            applyTable(values, y, [](V x, V y) { return x + y; });
+            return true;
+        case Binary::Subtract:
+            applyTable(values, y, [](V x, V y) { return x - y; });
+            return true;
+        case Binary::Multiply:
+            applyTable(values, y, [](V x, V y) { return x * y; });
+            return true;
+        case Binary::Divide:
+        case Binary::Modulo:
+            if (std::find(y.begin(), y.end(), 0) != y.end()) {
+                context.error(
+                    Error::Level::Fatal, "division by zero.", location
+                );
+                return false;
+            }
+            if (operation == Binary::Divide) {
+                applyTable(values, y, [](V x, V y) { return x / y; });
+            } else {
+                applyTable(values, y, [](V x, V y) { return x % y; });
+            }
+            return true;
+        case Binary::ShiftLeft:
+            applyTable(values, y, [](V x, V y) { return x << y; });
+            return true;
+        case Binary::ShiftRight:
+            applyTable(values, y, [](V x, V y) { return x >> y; });
+            return true;
+        case Binary::BinAnd:
+            applyTable(values, y, [](V x, V y) { return x & y; });
+            return true;
+        case Binary::BinOr:
+            applyTable(values, y, [](V x, V y) { return x | y; });
+            return true;
+        case Binary::BinXor:
+            applyTable(values, y, [](V x, V y) { return x ^ y; });
+            return true;
+        case Binary::And:
+            applyTable(values, y, [](V x, V y) -> V { return x && y; });
+            return true;
+        case Binary::Or:
+            applyTable(values, y, [](V x, V y) -> V { return x || y; });
+            return true;
+        case Binary::Greater:
+            applyTable(values, y, [](V x, V y) -> V { return x > y; });
+            return true;
+        case Binary::Less:
+            applyTable(values, y, [](V x, V y) -> V { return x < y; });
+            return true;
+        case Binary::GreaterEqual:
+            applyTable(values, y, [](V x, V y) -> V { return x >= y; });
+            return true;
+        case Binary::LessEqual:
+            applyTable(values, y, [](V x, V y) -> V { return x <= y; });
+            return true;
+        case Binary::Equal:
+            applyTable(values, y, [](V x, V y) -> V { return x == y; });
+            return true;
+        case Binary::NotEqual:
+            applyTable(values, y, [](V x, V y) -> V { return x != y; });
+            return true;
+    }
+    ASSEMBLER_ERROR("unsupported binary operator.");
+}
+
+bool BinaryExpression::isIterationInvariant() const {
+    return this->operand0->isIterationInvariant()
+        && this->operand1->isIterationInvariant();
+}
+
+void BinaryExpression::addMemoryUsage(MemoryTallies& usage) const {
+    usage["BinaryExpression"].add(sizeof(*this));
+    this->operand0->addMemoryUsage(usage);
+    this->operand1->addMemoryUsage(usage);
+}
+
 
 BinaryExpression::~BinaryExpression() {
     delete this->operand0;
@@ -116,6 +248,9 @@ UnaryExpression::UnaryExpression(
     operand{operand} {}
 
 std::optional<std::int64_t> UnaryExpression::evaluate(Context& context) const {
+    if (context.profile) {
+        ++context.profile->evaluations;
+    }
     auto result = this->operand->evaluate(context);
     if (!result.has_value()) {
         return result;
@@ -133,6 +268,62 @@ std::optional<std::int64_t> UnaryExpression::evaluate(Context& context) const {
     ASSEMBLER_ERROR("unsupported unary operator.");
 }
 
+std::optional<std::int64_t> UnaryExpression::getConstant() const {
+    auto result = this->operand->getConstant();
+    if (!result.has_value()) {
+        return result;
+    }
+    auto x = result.value();
+
+    switch (this->operation) {
+        case Unary::Negate:
+            return -x;
+        case Unary::Not:
+            return !x;
+        case Unary::BinNot:
+            return ~x;
+    }
+    ASSEMBLER_ERROR("unsupported unary operator.");
+}
+
+bool UnaryExpression::evaluateTable(
+    Context& context,
+    const TableIndex& index,
+    std::vector<std::int64_t>& values
+) const {
+    if (!this->operand->evaluateTable(context, index, values)) {
+        return false;
+    }
+
+    switch (this->operation) {
+        case Unary::Negate:
+            for (auto& x : values) {
+                x = -x;
+            }
+            return true;
+        case Unary::Not:
+            for (auto& x : values) {
+                x = !x;
+            }
+            return true;
+        case Unary::BinNot:
+            for (auto& x : values) {
+                x = ~x;
+            }
+            return true;
+    }
+    ASSEMBLER_ERROR("unsupported unary operator.");
+}
+
+bool UnaryExpression::isIterationInvariant() const {
+    return this->operand->isIterationInvariant();
+}
+
+void UnaryExpression::addMemoryUsage(MemoryTallies& usage) const {
+    usage["UnaryExpression"].add(sizeof(*this));
+    this->operand->addMemoryUsage(usage);
+}
+
 UnaryExpression::~UnaryExpression() {
     delete this->operand;
 }
@@ -144,24 +335,349 @@ SymbolicExpression::SymbolicExpression(Location location, UnqualifiedIdentifier
 std::optional<std::int64_t> SymbolicExpression::evaluate(
     Context& context
 ) const {
+    if (context.profile) {
+        ++context.profile->evaluations;
+        ++context.profile->symbolLookups;
+    }
     auto qualifiedId = context.qualify(this->location, this->identifier);
     auto symbol = context.assembler->resolveSymbol(qualifiedId);
 
     if (!symbol.has_value()) {
-        std::stringstream ss{};
-        ss << "cannot resolve symbol \'" << this->identifier << "\'";
-        context.error(Error::Level::Pass, ss.str(), this->location);
+        // Relocatable modules import top level symbols they do not define.
+        if (qualifiedId
+            && qualifiedId->value.size() == 1
+            && context.assembler->isRelocatable()
+        ) {
+            context.unresolved.insert(*qualifiedId);
+        }
+
+        context.error({
+            Error::Level::Pass,
+            Error::Code::UnresolvedSymbol,
+            this->location,
+            this->identifier
+        });
         return std::nullopt;
     }
 
+    if (context.assembler->isEliminatingRoutines()) {
+        std::string referrer = context.inOperand
+            ? context.currentRoutine.value_or("")
+            : "";
+        context.routineReferences[referrer].insert(qualifiedId->value[0]);
+    }
+
+    if (context.assembler->isRelocatable()) {
+        auto base = context.assembler->getSymbolBase(*qualifiedId);
+        if (base) {
+            context.relocationBases.insert(*base);
+            if (context.relocationShifts.contains(*base)) {
+                return *symbol + context.relocationShifts[*base];
+            }
+        }
+    }
+
     return *symbol;
 }
 
+bool SymbolicExpression::evaluateTable(
+    Context& context,
+    const TableIndex& index,
+    std::vector<std::int64_t>& values
+) const {
+    const auto& value = this->identifier.identifier.value;
+    if (this->identifier.depth == 0
+        && value.size() == 1
+        && value[0] == index.name
+    ) {
+        values = index.values;
+        return true;
+    }
+    return Expression::evaluateTable(context, index, values);
+}
+
+bool SymbolicExpression::isIterationInvariant() const {
+    // Local identifiers (including repeat counters) are qualified with the
+    // current loop index.
+    const auto& value = this->identifier.identifier.value;
+    return value.empty() || value[0] != "LOCAL";
+}
+
+void SymbolicExpression::addMemoryUsage(MemoryTallies& usage) const {
+    usage["SymbolicExpression"].add(
+        sizeof(*this) + getHeapSize(this->identifier.identifier)
+    );
+}
+
 
 LiteralExpression::LiteralExpression(Location location, std::int64_t value)
 : Expression{location}, value{value} {}
 
 std::optional<std::int64_t> LiteralExpression::evaluate(Context& context) const {
+    if (context.profile) {
+        ++context.profile->evaluations;
+    }
     return this->value;
 }
 
+std::optional<std::int64_t> LiteralExpression::getConstant() const {
+    return this->value;
+}
+
+bool LiteralExpression::isIterationInvariant() const {
+    return true;
+}
+
+void LiteralExpression::addMemoryUsage(MemoryTallies& usage) const {
+    usage["LiteralExpression"].add(sizeof(*this));
+}
+
+
+CallExpression::CallExpression(
+    Location location,
+    std::string name,
+    std::vector<Expression*> arguments
+) : Expression{location}, name{name}, arguments{arguments} {}
+
+std::optional<Builtin> CallExpression::checkCall(Context& context) const {
+    // Builtin, minimum and maximum argument count.
+    static const std::map<std::string, std::tuple<Builtin, std::size_t, std::size_t>>
+        builtins {
+            { "min", {Builtin::Min, 1, SIZE_MAX} },
+            { "max", {Builtin::Max, 1, SIZE_MAX} },
+            { "abs", {Builtin::Abs, 1, 1} },
+            { "clamp", {Builtin::Clamp, 3, 3} },
+            { "sqrt", {Builtin::Sqrt, 1, 1} },
+            { "log2", {Builtin::Log2, 1, 1} },
+            { "pow", {Builtin::Pow, 2, 2} },
+            { "sin", {Builtin::Sin, 3, 3} },
+            { "cos", {Builtin::Cos, 3, 3} },
+            { "gamma", {Builtin::Gamma, 3, 3} },
+            { "crc8", {Builtin::Crc8, 2, 2} },
+            { "crc16", {Builtin::Crc16, 2, 2} },
+        };
+
+    if (!builtins.contains(this->name)) {
+        context.error(
+            Error::Level::Fatal,
+            std::format("no such function '{}'", this->name),
+            this->location
+        );
+        return std::nullopt;
+    }
+
+    auto [builtin, minArgs, maxArgs] = builtins.at(this->name);
+    if (this->arguments.size() < minArgs || this->arguments.size() > maxArgs) {
+        context.error(
+            Error::Level::Fatal,
+            std::format(
+                "wrong number of arguments to '{}'",
+                this->name
+            ),
+            this->location
+        );
+        return std::nullopt;
+    }
+    return builtin;
+}
+
+std::int64_t crc(std::int64_t x, std::int64_t poly, int width) {
+    const std::uint64_t top = std::uint64_t{1} << (width - 1);
+    const std::uint64_t mask = (top << 1) - 1;
+
+    std::uint64_t value = (static_cast<std::uint64_t>(x) & 0xff) << (width - 8);
+    for (int i = 0; i < 8; ++i) {
+        value = (value & top) ? (value << 1) ^ poly : value << 1;
+    }
+    return value & mask;
+}
+
+std::optional<std::int64_t> CallExpression::performCall(
+    Context& context,
+    Builtin builtin,
+    const std::vector<std::int64_t>& args
+) const {
+    auto domainError = [&]() -> std::optional<std::int64_t> {
+        context.error(
+            Error::Level::Fatal,
+            std::format("argument out of domain of '{}'", this->name),
+            this->location
+        );
+        return std::nullopt;
+    };
+
+    auto overflowError = [&]() -> std::optional<std::int64_t> {
+        context.error(
+            Error::Level::Fatal,
+            std::format("result of '{}' overflows", this->name),
+            this->location
+        );
+        return std::nullopt;
+    };
+
+    switch (builtin) {
+        case Builtin::Min:
+            return *std::min_element(args.begin(), args.end());
+        case Builtin::Max:
+            return *std::max_element(args.begin(), args.end());
+        case Builtin::Abs:
+            return args[0] < 0 ? -args[0] : args[0];
+        case Builtin::Clamp:
+            if (args[1] > args[2]) {
+                return domainError();
+            }
+            return std::clamp(args[0], args[1], args[2]);
+        case Builtin::Sqrt:
+        {
+            if (args[0] < 0) {
+                return domainError();
+            }
+            auto root = static_cast<std::int64_t>(
+                std::sqrt(static_cast<double>(args[0]))
+            );
+            while (root * root > args[0]) {
+                --root;
+            }
+            while ((root + 1) * (root + 1) <= args[0]) {
+                ++root;
+            }
+            return root;
+        }
+        case Builtin::Log2:
+            if (args[0] <= 0) {
+                return domainError();
+            }
+            return std::bit_width(static_cast<std::uint64_t>(args[0])) - 1;
+        case Builtin::Pow:
+        {
+            if (args[1] < 0) {
+                return domainError();
+            }
+            // By squaring, so that large exponents fail fast.
+            std::int64_t result = 1;
+            std::int64_t base = args[0];
+            for (std::int64_t exponent = args[1]; exponent > 0; exponent >>= 1) {
+                if ((exponent & 1)
+                    && __builtin_mul_overflow(result, base, &result)
+                ) {
+                    return overflowError();
+                }
+                if (exponent > 1 && __builtin_mul_overflow(base, base, &base)) {
+                    return overflowError();
+                }
+            }
+            return result;
+        }
+        case Builtin::Sin:
+        case Builtin::Cos:
+        {
+            if (args[1] == 0) {
+                return domainError();
+            }
+            double angle = 2 * std::numbers::pi * args[0] / args[1];
+            double ratio = builtin == Builtin::Sin
+                ? std::sin(angle)
+                : std::cos(angle);
+            return std::llround(args[2] * ratio);
+        }
+        case Builtin::Gamma:
+            if (args[1] <= 0 || args[0] < 0) {
+                return domainError();
+            }
+            return std::llround(
+                args[1] * std::pow(
+                    static_cast<double>(args[0]) / args[1],
+                    args[2] / 100.0
+                )
+            );
+        case Builtin::Crc8:
+            return crc(args[0], args[1], 8);
+        case Builtin::Crc16:
+            return crc(args[0], args[1], 16);
+    }
+    ASSEMBLER_ERROR("unsupported builtin function.");
+}
+
+std::optional<std::int64_t> CallExpression::evaluate(Context& context) const {
+    if (context.profile) {
+        ++context.profile->evaluations;
+    }
+    auto builtin = this->checkCall(context);
+    if (!builtin) {
+        return std::nullopt;
+    }
+
+    std::vector<std::int64_t> args{};
+    bool success = true;
+    for (auto arg : this->arguments) {
+        auto value = arg->evaluate(context);
+        success = success && value.has_value();
+        args.push_back(value.value_or(0));
+    }
+
+    if (!success) {
+        return std::nullopt;
+    }
+    return this->performCall(context, *builtin, args);
+}
+
+bool CallExpression::evaluateTable(
+    Context& context,
+    const TableIndex& index,
+    std::vector<std::int64_t>& values
+) const {
+    auto builtin = this->checkCall(context);
+    if (!builtin) {
+        return false;
+    }
+
+    std::vector<std::vector<std::int64_t>> columns{this->arguments.size()};
+    bool success = true;
+    for (std::size_t i = 0; i < this->arguments.size(); ++i) {
+        success = this->arguments[i]->evaluateTable(context, index, columns[i])
+            && success;
+    }
+
+    if (!success) {
+        return false;
+    }
+
+    values.resize(index.values.size());
+    std::vector<std::int64_t> args(this->arguments.size());
+    for (std::size_t row = 0; row < values.size(); ++row) {
+        for (std::size_t i = 0; i < columns.size(); ++i) {
+            args[i] = columns[i][row];
+        }
+
+        auto result = this->performCall(context, *builtin, args);
+        if (!result) {
+            return false;
+        }
+        values[row] = *result;
+    }
+    return true;
+}
+
+bool CallExpression::isIterationInvariant() const {
+    for (auto arg : this->arguments) {
+        if (!arg->isIterationInvariant()) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void CallExpression::addMemoryUsage(MemoryTallies& usage) const {
+    usage["CallExpression"].add(
+        sizeof(*this) + getHeapSize(this->name) + getHeapSize(this->arguments)
+    );
+    for (const auto* argument : this->arguments) {
+        argument->addMemoryUsage(usage);
+    }
+}
+
+CallExpression::~CallExpression() {
+    for (auto arg : this->arguments) {
+        delete arg;
+    }
+}
@@ -3,10 +3,22 @@
 
 #include "Identifier.hpp"
 #include "Location.hpp"
+#include "MemoryReport.hpp"
 #include <cstdint>
+#include <string>
+#include <vector>
 
 class Context;
 
+// Index variable of a table directive and the values it takes.
+class TableIndex {
+public:
+    std::string name;
+    std::vector<std::int64_t> values;
+
+    TableIndex(std::string name, std::vector<std::int64_t> values);
+};
+
 class Expression {
 private:
 public:
@@ -17,6 +29,23 @@ public:
     virtual std::optional<std::int64_t> evaluate(Context& context) const = 0;
     std::optional<std::int64_t> mustEvaluate(Context& context) const;
 
+    // Value of the expression if it is known without a context.
+    virtual std::optional<std::int64_t> getConstant() const;
+
+    // True if the expression evaluates the same in every iteration of an
+    // enclosing repeat block.
+    virtual bool isIterationInvariant() const = 0;
+
+    // Evaluates the expression for every value of `index` at once, writing
+    // one result per index value to `values`.
+    virtual bool evaluateTable(
+        Context& context,
+        const TableIndex& index,
+        std::vector<std::int64_t>& values
+    ) const;
+
+    // Adds the expression and its operands to `usage`, by class.
+    virtual void addMemoryUsage(MemoryTallies& usage) const = 0;
 };
 
 enum class Binary {
@@ -56,6 +85,13 @@ public:
     BinaryExpression(Location location, Binary operation, 
         Expression* operand0, Expression* operand1);
     virtual std::optional<std::int64_t> evaluate(Context& context) const override;
+    virtual bool isIterationInvariant() const override;
+    virtual void addMemoryUsage(MemoryTallies& usage) const override;
+    virtual bool evaluateTable(
+        Context& context,
+        const TableIndex& index,
+        std::vector<std::int64_t>& values
+    ) const override;
 
     virtual ~BinaryExpression() override;
 };
@@ -73,6 +109,14 @@ private:
 public:
     UnaryExpression(Location location, Unary operation, Expression* operand);
     virtual std::optional<std::int64_t> evaluate(Context& context) const override;
+    virtual std::optional<std::int64_t> getConstant() const override;
+    virtual bool isIterationInvariant() const override;
+    virtual void addMemoryUsage(MemoryTallies& usage) const override;
+    virtual bool evaluateTable(
+        Context& context,
+        const TableIndex& index,
+        std::vector<std::int64_t>& values
+    ) const override;
 
     virtual ~UnaryExpression() override;
 };
@@ -84,6 +128,13 @@ public:
 
     SymbolicExpression(Location location, UnqualifiedIdentifier identifier);
     virtual std::optional<std::int64_t> evaluate(Context& context) const override;
+    virtual bool isIterationInvariant() const override;
+    virtual void addMemoryUsage(MemoryTallies& usage) const override;
+    virtual bool evaluateTable(
+        Context& context,
+        const TableIndex& index,
+        std::vector<std::int64_t>& values
+    ) const override;
 };
 
 class LiteralExpression : public Expression {
@@ -92,6 +143,55 @@ private:
 public:
     LiteralExpression(Location location, std::int64_t value);
     virtual std::optional<std::int64_t> evaluate(Context& context) const override;
+    virtual std::optional<std::int64_t> getConstant() const override;
+    virtual bool isIterationInvariant() const override;
+    virtual void addMemoryUsage(MemoryTallies& usage) const override;
+};
+
+enum class Builtin {
+    Min,
+    Max,
+    Abs,
+    Clamp,
+    Sqrt,
+    Log2,
+    Pow,
+    Sin,
+    Cos,
+    Gamma,
+    Crc8,
+    Crc16,
+};
+
+class CallExpression : public Expression {
+private:
+    std::string name;
+    std::vector<Expression*> arguments;
+
+    std::optional<std::int64_t> performCall(
+        Context& context,
+        Builtin builtin,
+        const std::vector<std::int64_t>& args
+    ) const;
+
+    std::optional<Builtin> checkCall(Context& context) const;
+
+public:
+    CallExpression(
+        Location location,
+        std::string name,
+        std::vector<Expression*> arguments
+    );
+    virtual std::optional<std::int64_t> evaluate(Context& context) const override;
+    virtual bool isIterationInvariant() const override;
+    virtual void addMemoryUsage(MemoryTallies& usage) const override;
+    virtual bool evaluateTable(
+        Context& context,
+        const TableIndex& index,
+        std::vector<std::int64_t>& values
+    ) const override;
+
+    virtual ~CallExpression() override;
 };
 
 #endif
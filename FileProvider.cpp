@@ -0,0 +1,120 @@
+#include "FileProvider.hpp"
+#include <fstream>
+#include <iterator>
+#include <system_error>
+
+FileProvider::~FileProvider() {}
+
+
+bool DiskFileProvider::exists(const std::string& path) const {
+    return std::filesystem::exists(path)
+        && !std::filesystem::is_directory(path);
+}
+
+std::optional<std::string> DiskFileProvider::read(const std::string& path) const {
+    std::ifstream stream{path, std::ios::binary};
+    if (!stream) {
+        return std::nullopt;
+    }
+
+    return std::string{
+        std::istreambuf_iterator<char>{stream},
+        std::istreambuf_iterator<char>{}
+    };
+}
+
+std::optional<FileStatus> DiskFileProvider::status(const std::string& path) const {
+    std::error_code error{};
+    FileStatus status{
+        std::filesystem::last_write_time(path, error),
+        std::filesystem::file_size(path, error)
+    };
+
+    if (error) {
+        return std::nullopt;
+    }
+    return status;
+}
+
+
+MemoryFileProvider::MemoryFileProvider()
+: mutex{}, files{}, versions{}, version{0} {}
+
+void MemoryFileProvider::setFile(const std::string& path, std::string contents) {
+    std::scoped_lock lock{this->mutex};
+    this->files[path] = std::move(contents);
+    this->versions[path] = ++this->version;
+}
+
+void MemoryFileProvider::removeFile(const std::string& path) {
+    std::scoped_lock lock{this->mutex};
+    this->files.erase(path);
+    this->versions.erase(path);
+}
+
+bool MemoryFileProvider::exists(const std::string& path) const {
+    std::scoped_lock lock{this->mutex};
+    return this->files.contains(path);
+}
+
+std::optional<std::string> MemoryFileProvider::read(const std::string& path) const {
+    std::scoped_lock lock{this->mutex};
+    auto file = this->files.find(path);
+    if (file == this->files.end()) {
+        return std::nullopt;
+    }
+    return file->second;
+}
+
+std::optional<FileStatus> MemoryFileProvider::status(const std::string& path) const {
+    std::scoped_lock lock{this->mutex};
+    auto file = this->files.find(path);
+    if (file == this->files.end()) {
+        return std::nullopt;
+    }
+
+    // Every change gets a new version, which stands in for the time.
+    return FileStatus{
+        std::filesystem::file_time_type{
+            std::filesystem::file_time_type::duration{this->versions.at(path)}
+        },
+        file->second.size()
+    };
+}
+
+
+std::string getOverlayPath(const std::string& path) {
+    return std::filesystem::absolute(path).lexically_normal().string();
+}
+
+OverlayFileProvider::OverlayFileProvider(const FileProvider& base)
+: overlay{}, base{base} {}
+
+void OverlayFileProvider::setFile(const std::string& path, std::string contents) {
+    this->overlay.setFile(getOverlayPath(path), std::move(contents));
+}
+
+void OverlayFileProvider::removeFile(const std::string& path) {
+    this->overlay.removeFile(getOverlayPath(path));
+}
+
+bool OverlayFileProvider::exists(const std::string& path) const {
+    return this->overlay.exists(getOverlayPath(path)) || this->base.exists(path);
+}
+
+std::optional<std::string> OverlayFileProvider::read(const std::string& path) const {
+    auto contents = this->overlay.read(getOverlayPath(path));
+    return contents ? contents : this->base.read(path);
+}
+
+std::optional<FileStatus> OverlayFileProvider::status(const std::string& path) const {
+    auto status = this->overlay.status(getOverlayPath(path));
+    return status ? status : this->base.status(path);
+}
+
+
+const FileProvider& getDiskFileProvider() {
+    static const DiskFileProvider diskFileProvider{};
+    return diskFileProvider;
+}
+
@@ -0,0 +1,79 @@
+#ifndef FILEPROVIDER_HPP
+#define FILEPROVIDER_HPP
+
+#include <cstdint>
+#include <filesystem>
+#include <map>
+#include <mutex>
+#include <optional>
+#include <string>
+
+class FileStatus {
+public:
+    std::filesystem::file_time_type modified;
+    std::uintmax_t size;
+};
+
+// Where source files are read from.
+class FileProvider {
+public:
+    virtual ~FileProvider();
+
+    virtual bool exists(const std::string& path) const = 0;
+
+    virtual std::optional<std::string> read(const std::string& path) const = 0;
+
+    // Changes whenever the contents of `path` may have changed.
+    virtual std::optional<FileStatus> status(const std::string& path) const = 0;
+};
+
+class DiskFileProvider : public FileProvider {
+public:
+    virtual bool exists(const std::string& path) const override;
+    virtual std::optional<std::string> read(const std::string& path) const override;
+    virtual std::optional<FileStatus> status(const std::string& path) const override;
+};
+
+// Files held in memory, such as sources produced by a code generator.
+// Paths are matched exactly, so include path entries are joined with '/'.
+class MemoryFileProvider : public FileProvider {
+private:
+    mutable std::mutex mutex;
+    std::map<std::string, std::string> files;
+    std::map<std::string, std::int64_t> versions;
+    std::int64_t version;
+
+public:
+    MemoryFileProvider();
+
+    void setFile(const std::string& path, std::string contents);
+    void removeFile(const std::string& path);
+
+    virtual bool exists(const std::string& path) const override;
+    virtual std::optional<std::string> read(const std::string& path) const override;
+    virtual std::optional<FileStatus> status(const std::string& path) const override;
+};
+
+// Files held in memory in front of another provider, such as the unsaved
+// buffers of an editor over the disk. Paths are compared after making them
+// absolute, so relative includes find the buffers too.
+class OverlayFileProvider : public FileProvider {
+private:
+    MemoryFileProvider overlay;
+    const FileProvider& base;
+
+public:
+    OverlayFileProvider(const FileProvider& base);
+
+    void setFile(const std::string& path, std::string contents);
+    void removeFile(const std::string& path);
+
+    virtual bool exists(const std::string& path) const override;
+    virtual std::optional<std::string> read(const std::string& path) const override;
+    virtual std::optional<FileStatus> status(const std::string& path) const override;
+};
+
+const FileProvider& getDiskFileProvider();
+
+#endif
+
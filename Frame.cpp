@@ -34,6 +34,10 @@ void FrameStack::pop() {
     this->frames.pop_back();
 }
 
+void FrameStack::clear() {
+    this->frames.clear();
+}
+
 
 std::string FrameStack::getLocalIdent() {
     return this->getIdent([](const Frame::TypeInfo& info) {
@@ -41,6 +41,7 @@ public:
 
     void push(Frame frame);
     void pop();
+    void clear();
 
     std::string getLocalIdent();
     std::string getMacroIdent();
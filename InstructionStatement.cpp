@@ -36,3 +36,24 @@ bool InstructionStatement::assemble(Context& context) {
     //return this->assembleInstruction(context, this->instruction);
 }
 
+void InstructionStatement::addMemoryUsage(MemoryTallies& usage) const {
+    // The instruction's own name and mode are not visible here.
+    usage["InstructionStatement"].add(sizeof(*this) + getHeapSize(this->arguments));
+    for (const auto* argument : this->arguments) {
+        argument->addMemoryUsage(usage);
+    }
+}
+
+bool InstructionStatement::isIterationInvariant(const Context& context) const {
+    if (context.macros.contains(this->instruction)) {
+        return false;
+    }
+
+    for (auto expr : this->arguments) {
+        if (expr && !expr->isIterationInvariant()) {
+            return false;
+        }
+    }
+    return true;
+}
+
@@ -29,6 +29,8 @@ public:
     virtual ~InstructionStatement() override;
 
     virtual bool assemble(Context& context) override;
+    virtual void addMemoryUsage(MemoryTallies& usage) const override;
+    virtual bool isIterationInvariant(const Context& context) const override;
 };
 
 #endif
@@ -0,0 +1,446 @@
+#include "Json.hpp"
+#include <cmath>
+#include <cstdlib>
+#include <format>
+#include <sstream>
+
+// Deeper nesting is rejected rather than risking the stack.
+const int maxJsonDepth = 256;
+
+Json::Json()
+:   type{Type::Null},
+    boolean{false},
+    number{0},
+    string{},
+    array{},
+    object{} {}
+
+Json::Json(bool value) : Json{} {
+    this->type = Type::Boolean;
+    this->boolean = value;
+}
+
+Json::Json(int value) : Json{static_cast<double>(value)} {}
+
+Json::Json(std::int64_t value) : Json{static_cast<double>(value)} {}
+
+Json::Json(double value) : Json{} {
+    this->type = Type::Number;
+    this->number = value;
+}
+
+Json::Json(std::string value) : Json{} {
+    this->type = Type::String;
+    this->string = std::move(value);
+}
+
+Json::Json(const char* value) : Json{std::string{value}} {}
+
+Json Json::makeArray() {
+    Json json{};
+    json.type = Type::Array;
+    return json;
+}
+
+Json Json::makeObject() {
+    Json json{};
+    json.type = Type::Object;
+    return json;
+}
+
+bool Json::isNull() const {
+    return this->type == Type::Null;
+}
+
+const Json& Json::operator[](const std::string& key) const {
+    static const Json null{};
+
+    if (this->type != Type::Object) {
+        return null;
+    }
+
+    auto member = this->object.find(key);
+    return member == this->object.end() ? null : member->second;
+}
+
+Json& Json::operator[](const std::string& key) {
+    if (this->type != Type::Object) {
+        *this = Json::makeObject();
+    }
+    return this->object[key];
+}
+
+void Json::push(Json value) {
+    if (this->type != Type::Array) {
+        *this = Json::makeArray();
+    }
+    this->array.push_back(std::move(value));
+}
+
+std::optional<std::int64_t> Json::getInteger() const {
+    if (this->type != Type::Number || this->number != std::trunc(this->number)) {
+        return std::nullopt;
+    }
+    return static_cast<std::int64_t>(this->number);
+}
+
+std::optional<std::string> Json::getString() const {
+    if (this->type != Type::String) {
+        return std::nullopt;
+    }
+    return this->string;
+}
+
+void writeJsonString(std::ostream& stream, const std::string& str) {
+    stream << '"';
+    for (char c : str) {
+        switch (c) {
+            case '"':
+                stream << "\\\"";
+                break;
+            case '\\':
+                stream << "\\\\";
+                break;
+            case '\n':
+                stream << "\\n";
+                break;
+            case '\r':
+                stream << "\\r";
+                break;
+            case '\t':
+                stream << "\\t";
+                break;
+            default:
+                if (static_cast<unsigned char>(c) < 0x20) {
+                    stream << std::format("\\u{:04x}", static_cast<int>(c));
+                } else {
+                    stream << c;
+                }
+        }
+    }
+    stream << '"';
+}
+
+void Json::write(std::ostream& stream) const {
+    switch (this->type) {
+        case Type::Null:
+            stream << "null";
+            break;
+        case Type::Boolean:
+            stream << (this->boolean ? "true" : "false");
+            break;
+        case Type::Number:
+            if (auto integer = this->getInteger()) {
+                stream << *integer;
+            } else if (std::isfinite(this->number)) {
+                std::stringstream ss{};
+                ss.precision(17);
+                ss << this->number;
+                stream << ss.str();
+            } else {
+                stream << "null";
+            }
+            break;
+        case Type::String:
+            writeJsonString(stream, this->string);
+            break;
+        case Type::Array:
+        {
+            stream << '[';
+            bool first = true;
+            for (const auto& element : this->array) {
+                if (!first) {
+                    stream << ',';
+                }
+                first = false;
+                element.write(stream);
+            }
+            stream << ']';
+        }
+            break;
+        case Type::Object:
+        {
+            stream << '{';
+            bool first = true;
+            for (const auto& member : this->object) {
+                if (!first) {
+                    stream << ',';
+                }
+                first = false;
+                writeJsonString(stream, member.first);
+                stream << ':';
+                member.second.write(stream);
+            }
+            stream << '}';
+        }
+            break;
+    }
+}
+
+std::string Json::toString() const {
+    std::stringstream ss{};
+    this->write(ss);
+    return ss.str();
+}
+
+
+class JsonParser {
+private:
+    std::string_view text;
+    std::size_t position;
+    int depth;
+
+public:
+    JsonParser(std::string_view text);
+
+    void skipSpace();
+    bool consume(std::string_view literal);
+    bool atEnd();
+
+    std::optional<std::uint32_t> readHex();
+    std::optional<std::string> readString();
+    std::optional<Json> readNumber();
+    std::optional<Json> readValue();
+};
+
+JsonParser::JsonParser(std::string_view text)
+: text{text}, position{0}, depth{0} {}
+
+void JsonParser::skipSpace() {
+    while (this->position < this->text.size()) {
+        char c = this->text[this->position];
+        if (c != ' ' && c != '\t' && c != '\n' && c != '\r') {
+            return;
+        }
+        ++this->position;
+    }
+}
+
+bool JsonParser::consume(std::string_view literal) {
+    this->skipSpace();
+    if (!this->text.substr(this->position).starts_with(literal)) {
+        return false;
+    }
+    this->position += literal.size();
+    return true;
+}
+
+bool JsonParser::atEnd() {
+    this->skipSpace();
+    return this->position == this->text.size();
+}
+
+std::optional<std::uint32_t> JsonParser::readHex() {
+    if (this->position + 4 > this->text.size()) {
+        return std::nullopt;
+    }
+
+    std::uint32_t value = 0;
+    for (int i = 0; i < 4; ++i) {
+        char c = this->text[this->position++];
+        value <<= 4;
+        if (c >= '0' && c <= '9') {
+            value |= c - '0';
+        } else if (c >= 'a' && c <= 'f') {
+            value |= c - 'a' + 10;
+        } else if (c >= 'A' && c <= 'F') {
+            value |= c - 'A' + 10;
+        } else {
+            return std::nullopt;
+        }
+    }
+    return value;
+}
+
+void appendUtf8(std::string& str, std::uint32_t codePoint) {
+    if (codePoint < 0x80) {
+        str += static_cast<char>(codePoint);
+    } else if (codePoint < 0x800) {
+        str += static_cast<char>(0xc0 | (codePoint >> 6));
+        str += static_cast<char>(0x80 | (codePoint & 0x3f));
+    } else if (codePoint < 0x10000) {
+        str += static_cast<char>(0xe0 | (codePoint >> 12));
+        str += static_cast<char>(0x80 | ((codePoint >> 6) & 0x3f));
+        str += static_cast<char>(0x80 | (codePoint & 0x3f));
+    } else {
+        str += static_cast<char>(0xf0 | (codePoint >> 18));
+        str += static_cast<char>(0x80 | ((codePoint >> 12) & 0x3f));
+        str += static_cast<char>(0x80 | ((codePoint >> 6) & 0x3f));
+        str += static_cast<char>(0x80 | (codePoint & 0x3f));
+    }
+}
+
+std::optional<std::string> JsonParser::readString() {
+    if (!this->consume("\"")) {
+        return std::nullopt;
+    }
+
+    std::string str{};
+    while (this->position < this->text.size()) {
+        char c = this->text[this->position++];
+        if (c == '"') {
+            return str;
+        }
+        if (c != '\\') {
+            str += c;
+            continue;
+        }
+
+        if (this->position >= this->text.size()) {
+            return std::nullopt;
+        }
+
+        char escape = this->text[this->position++];
+        switch (escape) {
+            case '"':
+            case '\\':
+            case '/':
+                str += escape;
+                break;
+            case 'b':
+                str += '\b';
+                break;
+            case 'f':
+                str += '\f';
+                break;
+            case 'n':
+                str += '\n';
+                break;
+            case 'r':
+                str += '\r';
+                break;
+            case 't':
+                str += '\t';
+                break;
+            case 'u':
+            {
+                auto codePoint = this->readHex();
+                if (!codePoint) {
+                    return std::nullopt;
+                }
+
+                // Characters outside the basic plane come as surrogate pairs.
+                if (*codePoint >= 0xd800 && *codePoint < 0xdc00
+                    && this->text.substr(this->position).starts_with("\\u")
+                ) {
+                    this->position += 2;
+                    auto low = this->readHex();
+                    if (!low || *low < 0xdc00 || *low >= 0xe000) {
+                        return std::nullopt;
+                    }
+                    *codePoint = 0x10000
+                        + ((*codePoint - 0xd800) << 10)
+                        + (*low - 0xdc00);
+                }
+                appendUtf8(str, *codePoint);
+            }
+                break;
+            default:
+                return std::nullopt;
+        }
+    }
+    return std::nullopt;
+}
+
+std::optional<Json> JsonParser::readNumber() {
+    std::size_t start = this->position;
+    while (this->position < this->text.size()) {
+        char c = this->text[this->position];
+        if (!(c >= '0' && c <= '9')
+            && c != '-' && c != '+' && c != '.' && c != 'e' && c != 'E'
+        ) {
+            break;
+        }
+        ++this->position;
+    }
+
+    std::string number{this->text.substr(start, this->position - start)};
+    char* end = nullptr;
+    double value = std::strtod(number.c_str(), &end);
+    if (number.empty() || end != number.c_str() + number.size()) {
+        return std::nullopt;
+    }
+    return Json{value};
+}
+
+std::optional<Json> JsonParser::readValue() {
+    this->skipSpace();
+    if (this->position >= this->text.size() || this->depth >= maxJsonDepth) {
+        return std::nullopt;
+    }
+
+    switch (this->text[this->position]) {
+        case 'n':
+            return this->consume("null") ? std::optional{Json{}} : std::nullopt;
+        case 't':
+            return this->consume("true") ? std::optional{Json{true}} : std::nullopt;
+        case 'f':
+            return this->consume("false") ? std::optional{Json{false}} : std::nullopt;
+        case '"':
+        {
+            auto str = this->readString();
+            if (!str) {
+                return std::nullopt;
+            }
+            return Json{std::move(*str)};
+        }
+        case '[':
+        {
+            ++this->position;
+            ++this->depth;
+            Json array = Json::makeArray();
+            if (!this->consume("]")) {
+                do {
+                    auto element = this->readValue();
+                    if (!element) {
+                        return std::nullopt;
+                    }
+                    array.push(std::move(*element));
+                } while (this->consume(","));
+
+                if (!this->consume("]")) {
+                    return std::nullopt;
+                }
+            }
+            --this->depth;
+            return array;
+        }
+        case '{':
+        {
+            ++this->position;
+            ++this->depth;
+            Json object = Json::makeObject();
+            if (!this->consume("}")) {
+                do {
+                    auto key = this->readString();
+                    if (!key || !this->consume(":")) {
+                        return std::nullopt;
+                    }
+                    auto value = this->readValue();
+                    if (!value) {
+                        return std::nullopt;
+                    }
+                    object.object[*key] = std::move(*value);
+                } while (this->consume(","));
+
+                if (!this->consume("}")) {
+                    return std::nullopt;
+                }
+            }
+            --this->depth;
+            return object;
+        }
+        default:
+            return this->readNumber();
+    }
+}
+
+std::optional<Json> Json::parse(std::string_view text) {
+    JsonParser parser{text};
+    auto value = parser.readValue();
+    if (!value || !parser.atEnd()) {
+        return std::nullopt;
+    }
+    return value;
+}
+
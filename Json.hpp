@@ -0,0 +1,61 @@
+#ifndef JSON_HPP
+#define JSON_HPP
+
+#include <cstdint>
+#include <iostream>
+#include <map>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// A JSON value, enough for the messages of the language server.
+class Json {
+public:
+    enum class Type {
+        Null,
+        Boolean,
+        Number,
+        String,
+        Array,
+        Object,
+    };
+
+    Type type;
+    bool boolean;
+    double number;
+    std::string string;
+    std::vector<Json> array;
+    std::map<std::string, Json> object;
+
+    Json();
+    Json(bool value);
+    Json(int value);
+    Json(std::int64_t value);
+    Json(double value);
+    Json(std::string value);
+    Json(const char* value);
+
+    static Json makeArray();
+    static Json makeObject();
+
+    bool isNull() const;
+
+    // Members of objects. Missing members and members of other types read
+    // as null; assigning makes the value an object.
+    const Json& operator[](const std::string& key) const;
+    Json& operator[](const std::string& key);
+
+    void push(Json value);
+
+    std::optional<std::int64_t> getInteger() const;
+    std::optional<std::string> getString() const;
+
+    void write(std::ostream& stream) const;
+    std::string toString() const;
+
+    static std::optional<Json> parse(std::string_view text);
+};
+
+#endif
+
@@ -0,0 +1,765 @@
+#include "LanguageServer.hpp"
+#include "Context.hpp"
+#include "MacroStatement.hpp"
+#include <poll.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cctype>
+#include <cerrno>
+#include <cstring>
+#include <filesystem>
+#include <format>
+#include <sstream>
+
+// Messages are a header, of which only Content-Length matters, a blank
+// line and a JSON body of that many bytes.
+
+const int parseError = -32700;
+const int invalidRequest = -32600;
+const int methodNotFound = -32601;
+const int internalError = -32603;
+
+const int severityError = 1;
+const int symbolKindFunction = 12;
+const int symbolKindConstant = 14;
+
+const int textDocumentSyncFull = 1;
+
+class MessageReader {
+private:
+    int fd;
+    std::string buffer;
+
+    bool fill();
+
+public:
+    MessageReader(int fd);
+
+    // Returns the next message body, or nothing at the end of the input.
+    std::optional<std::string> read();
+
+    // Whether more input can be read without waiting.
+    bool hasPending() const;
+};
+
+MessageReader::MessageReader(int fd) : fd{fd}, buffer{} {}
+
+bool MessageReader::fill() {
+    char data[4096];
+    ssize_t count;
+    do {
+        count = ::read(this->fd, data, sizeof(data));
+    } while (count < 0 && errno == EINTR);
+
+    if (count <= 0) {
+        return false;
+    }
+    this->buffer.append(data, count);
+    return true;
+}
+
+std::optional<std::string> MessageReader::read() {
+    std::size_t headerEnd;
+    while ((headerEnd = this->buffer.find("\r\n\r\n")) == std::string::npos) {
+        if (!this->fill()) {
+            return std::nullopt;
+        }
+    }
+
+    std::optional<std::size_t> length{};
+    std::stringstream header{this->buffer.substr(0, headerEnd)};
+    std::string line{};
+    while (std::getline(header, line)) {
+        auto colon = line.find(':');
+        std::string name = line.substr(0, colon);
+        std::transform(name.begin(), name.end(), name.begin(), [](char c) {
+            return std::tolower(static_cast<unsigned char>(c));
+        });
+
+        if (colon != std::string::npos && name == "content-length") {
+            try {
+                length = std::stoul(line.substr(colon + 1));
+            } catch (const std::logic_error&) {
+                length = std::nullopt;
+            }
+        }
+    }
+
+    std::size_t bodyStart = headerEnd + 4;
+    if (!length) {
+        // Without a length the body cannot be found, so skip the header.
+        this->buffer.erase(0, bodyStart);
+        return std::string{};
+    }
+
+    while (this->buffer.size() < bodyStart + *length) {
+        if (!this->fill()) {
+            return std::nullopt;
+        }
+    }
+
+    std::string body = this->buffer.substr(bodyStart, *length);
+    this->buffer.erase(0, bodyStart + *length);
+    return body;
+}
+
+bool MessageReader::hasPending() const {
+    pollfd pfd{this->fd, POLLIN, 0};
+    return !this->buffer.empty() || ::poll(&pfd, 1, 0) > 0;
+}
+
+
+std::string getAbsolutePath(const std::string& path) {
+    return std::filesystem::absolute(path).lexically_normal().string();
+}
+
+std::optional<std::string> uriToPath(const std::string& uri) {
+    const std::string scheme = "file://";
+    if (!uri.starts_with(scheme)) {
+        return std::nullopt;
+    }
+
+    std::string path{};
+    for (std::size_t i = scheme.size(); i < uri.size(); ++i) {
+        if (uri[i] == '%' && i + 2 < uri.size()) {
+            try {
+                path += static_cast<char>(std::stoi(uri.substr(i + 1, 2), nullptr, 16));
+                i += 2;
+                continue;
+            } catch (const std::logic_error&) {}
+        }
+        path += uri[i];
+    }
+    return getAbsolutePath(path);
+}
+
+std::string pathToUri(const std::string& path) {
+    std::string uri = "file://";
+    for (char c : path) {
+        if (std::isalnum(static_cast<unsigned char>(c))
+            || std::strchr("/-._~", c)
+        ) {
+            uri += c;
+        } else {
+            uri += std::format("%{:02X}", static_cast<unsigned char>(c));
+        }
+    }
+    return uri;
+}
+
+Json positionToJson(int line, int column) {
+    Json position = Json::makeObject();
+    position["line"] = std::max(line, 0);
+    position["character"] = std::max(column, 0);
+    return position;
+}
+
+Json rangeToJson(const SourcePosition& begin, const SourcePosition& end) {
+    Json range = Json::makeObject();
+    range["start"] = positionToJson(begin.line, begin.column);
+    range["end"] = positionToJson(end.line, end.column);
+    return range;
+}
+
+Json rangeToJson(const SourcePosition& position) {
+    return rangeToJson(position, position);
+}
+
+Json locationToJson(const SourcePosition& position) {
+    Json location = Json::makeObject();
+    location["uri"] = pathToUri(position.path);
+    location["range"] = rangeToJson(position);
+    return location;
+}
+
+bool isIdentifierCharacter(char c) {
+    return std::isalnum(static_cast<unsigned char>(c)) || c == '_' || c == '.';
+}
+
+
+LanguageServer::LanguageServer(
+    SectionMode sectionMode,
+    std::vector<std::string> includePath,
+    std::optional<std::string> prelude,
+    std::map<Identifier, std::int64_t> definitions,
+    std::vector<std::string> roots,
+    std::ostream& output,
+    std::ostream& errors
+)
+:   output{output},
+    errors{errors},
+    instructionSet{},
+    fileProvider{getDiskFileProvider()},
+    parseCache{includePath, &this->fileProvider},
+    assembler{sectionMode, this->instructionSet, this->parseCache, prelude},
+    roots{roots},
+    documents{},
+    analyses{},
+    publishedFiles{},
+    stale{false},
+    shuttingDown{false}
+{
+    this->assembler.setDefinitions(definitions);
+}
+
+void LanguageServer::send(const Json& message) {
+    std::string body = message.toString();
+    this->output << "Content-Length: " << body.size() << "\r\n\r\n" << body;
+    this->output.flush();
+}
+
+void LanguageServer::respond(const Json& id, Json result) {
+    Json message = Json::makeObject();
+    message["jsonrpc"] = "2.0";
+    message["id"] = id;
+    message["result"] = std::move(result);
+    this->send(message);
+}
+
+void LanguageServer::respondError(
+    const Json& id,
+    int code,
+    const std::string& text
+) {
+    Json message = Json::makeObject();
+    message["jsonrpc"] = "2.0";
+    message["id"] = id;
+    message["error"]["code"] = code;
+    message["error"]["message"] = text;
+    this->send(message);
+}
+
+void LanguageServer::notify(const std::string& method, Json params) {
+    Json message = Json::makeObject();
+    message["jsonrpc"] = "2.0";
+    message["method"] = method;
+    message["params"] = std::move(params);
+    this->send(message);
+}
+
+/// Analysis
+
+std::string LanguageServer::getSourcePath(const std::string& fileName) const {
+    auto path = this->parseCache.getPath(fileName);
+    return getAbsolutePath(path.value_or(fileName));
+}
+
+SourcePosition LanguageServer::getSourcePosition(
+    const yy::position& position,
+    const std::string& defaultPath
+) const {
+    return SourcePosition{
+        position.filename
+            ? this->getSourcePath(*position.filename)
+            : defaultPath,
+        static_cast<int>(position.line) - 1,
+        static_cast<int>(position.column) - 1
+    };
+}
+
+Json getDiagnostic(
+    const SourcePosition& begin,
+    const SourcePosition& end,
+    const std::string& message
+) {
+    Json diagnostic = Json::makeObject();
+    diagnostic["range"] = rangeToJson(begin, end);
+    diagnostic["severity"] = severityError;
+    diagnostic["source"] = "aspdr";
+    diagnostic["message"] = message;
+    return diagnostic;
+}
+
+Analysis LanguageServer::analyzeRoot(const std::string& root) {
+    Analysis analysis{root, {root}, {}, {}, {}};
+
+    std::stringstream report{};
+    Context context = this->assembler.build(root, report);
+
+    for (const auto& dependency : context.dependencies) {
+        analysis.files.insert(getAbsolutePath(dependency));
+    }
+
+    for (const auto& symbol : this->assembler.getSymbols()) {
+        auto location = context.symbolLocations.find(symbol.first);
+        if (location == context.symbolLocations.end()
+            || !location->second.begin.filename
+        ) {
+            continue;
+        }
+
+        analysis.symbols[symbol.first] = SourceSymbol{
+            symbol.second,
+            context.labels.contains(symbol.first),
+            this->getSourcePosition(location->second.begin, root)
+        };
+    }
+
+    for (const auto& macro : context.macros) {
+        if (macro.second->location.begin.filename) {
+            analysis.macros.try_emplace(
+                macro.second->name,
+                this->getSourcePosition(macro.second->location.begin, root)
+            );
+        }
+    }
+
+    // Errors without a location are shown at the start of the program.
+    for (const auto& error : context.getErrors()) {
+        SourcePosition begin{root, 0, 0};
+        SourcePosition end{root, 0, 0};
+        if (error.location) {
+            begin = this->getSourcePosition(error.location->begin, root);
+            end = this->getSourcePosition(error.location->end, root);
+        }
+
+        analysis.diagnostics[begin.path].push_back(
+            getDiagnostic(begin, end, error.getMessage())
+        );
+    }
+
+    if (context.getSuppressedErrors() > 0) {
+        SourcePosition start{root, 0, 0};
+        analysis.diagnostics[root].push_back(getDiagnostic(
+            start,
+            start,
+            std::format("{} more errors", context.getSuppressedErrors())
+        ));
+    }
+
+    return analysis;
+}
+
+void LanguageServer::analyze() {
+    this->stale = false;
+    this->parseCache.refresh();
+
+    std::vector<std::string> candidates{};
+    for (const auto& root : this->roots) {
+        candidates.push_back(getAbsolutePath(root));
+    }
+    if (this->roots.empty()) {
+        candidates.assign(this->documents.begin(), this->documents.end());
+    }
+
+    auto isIncluded = [&](const std::string& path) {
+        return std::any_of(
+            this->analyses.begin(),
+            this->analyses.end(),
+            [&](const Analysis& analysis) {
+                return analysis.root != path && analysis.files.contains(path);
+            }
+        );
+    };
+
+    this->analyses.clear();
+    for (const auto& root : candidates) {
+        if (!this->roots.empty() || !isIncluded(root)) {
+            try {
+                this->analyses.push_back(this->analyzeRoot(root));
+            } catch (const std::exception& error) {
+                Json params = Json::makeObject();
+                params["type"] = severityError;
+                params["message"] = std::format("{}: {}", root, error.what());
+                this->notify("window/logMessage", params);
+            }
+        }
+    }
+
+    // A document opened before the program including it was assembled on
+    // its own. Its own errors are those of a fragment, so drop them.
+    // Found before erasing, since whether a root is included depends on
+    // the other analyses.
+    if (this->roots.empty()) {
+        std::set<std::string> included{};
+        for (const auto& analysis : this->analyses) {
+            if (isIncluded(analysis.root)) {
+                included.insert(analysis.root);
+            }
+        }
+        std::erase_if(this->analyses, [&](const Analysis& analysis) {
+            return included.contains(analysis.root);
+        });
+    }
+
+    this->publishDiagnostics();
+}
+
+void LanguageServer::publishDiagnostics() {
+    std::map<std::string, Json> diagnostics{};
+    for (const auto& path : this->publishedFiles) {
+        diagnostics[path] = Json::makeArray();
+    }
+
+    for (const auto& analysis : this->analyses) {
+        for (const auto& file : analysis.diagnostics) {
+            Json& list = diagnostics[file.first];
+            list.type = Json::Type::Array;
+            for (const auto& diagnostic : file.second) {
+                list.push(diagnostic);
+            }
+        }
+    }
+
+    this->publishedFiles.clear();
+    for (auto& file : diagnostics) {
+        if (!file.second.array.empty()) {
+            this->publishedFiles.insert(file.first);
+        }
+
+        Json params = Json::makeObject();
+        params["uri"] = pathToUri(file.first);
+        params["diagnostics"] = std::move(file.second);
+        this->notify("textDocument/publishDiagnostics", params);
+    }
+}
+
+/// Navigation
+
+std::optional<std::string> LanguageServer::getWord(
+    const std::string& path,
+    int line,
+    int column
+) const {
+    auto contents = this->fileProvider.read(path);
+    if (!contents || line < 0 || column < 0) {
+        return std::nullopt;
+    }
+
+    std::size_t start = 0;
+    for (int i = 0; i < line; ++i) {
+        start = contents->find('\n', start);
+        if (start == std::string::npos) {
+            return std::nullopt;
+        }
+        ++start;
+    }
+
+    std::size_t end = std::min(contents->find('\n', start), contents->size());
+    std::size_t position = start + column;
+    if (position > end) {
+        return std::nullopt;
+    }
+
+    std::size_t wordStart = position;
+    while (wordStart > start && isIdentifierCharacter((*contents)[wordStart - 1])) {
+        --wordStart;
+    }
+    std::size_t wordEnd = position;
+    while (wordEnd < end && isIdentifierCharacter((*contents)[wordEnd])) {
+        ++wordEnd;
+    }
+
+    if (wordStart == wordEnd) {
+        return std::nullopt;
+    }
+    return contents->substr(wordStart, wordEnd - wordStart);
+}
+
+std::optional<std::pair<Identifier, const SourceSymbol*>> LanguageServer::findSymbol(
+    const std::string& path,
+    int line,
+    int column
+) const {
+    auto word = this->getWord(path, line, column);
+    if (!word) {
+        return std::nullopt;
+    }
+
+    auto unqualified = UnqualifiedIdentifier::fromString(*word);
+    if (unqualified.identifier.value.empty()) {
+        return std::nullopt;
+    }
+
+    for (const auto& analysis : this->analyses) {
+        if (!analysis.files.contains(path)) {
+            continue;
+        }
+
+        // Local names are relative to the last label before them.
+        const Identifier* scope = nullptr;
+        std::pair<int, int> scopePosition{-1, -1};
+        for (const auto& symbol : analysis.symbols) {
+            const SourcePosition& position = symbol.second.position;
+            std::pair<int, int> symbolPosition{position.line, position.column};
+
+            if (symbol.second.label
+                && position.path == path
+                && symbolPosition <= std::pair{line, column}
+                && symbolPosition > scopePosition
+            ) {
+                scope = &symbol.first;
+                scopePosition = symbolPosition;
+            }
+        }
+
+        std::size_t depth = unqualified.depth;
+        if (depth > 0 && (!scope || scope->value.size() < depth)) {
+            continue;
+        }
+
+        std::vector<std::string> value{};
+        if (depth > 0) {
+            value.assign(scope->value.begin(), scope->value.begin() + depth);
+        }
+        value.insert(
+            value.end(),
+            unqualified.identifier.value.begin(),
+            unqualified.identifier.value.end()
+        );
+
+        Identifier identifier{value};
+        auto symbol = analysis.symbols.find(identifier);
+        if (symbol != analysis.symbols.end()) {
+            return std::pair{identifier, &symbol->second};
+        }
+    }
+    return std::nullopt;
+}
+
+std::optional<SourcePosition> LanguageServer::findDefinition(
+    const std::string& path,
+    int line,
+    int column
+) const {
+    auto symbol = this->findSymbol(path, line, column);
+    if (symbol) {
+        return symbol->second->position;
+    }
+
+    auto word = this->getWord(path, line, column);
+    if (!word) {
+        return std::nullopt;
+    }
+
+    for (const auto& analysis : this->analyses) {
+        auto macro = analysis.macros.find(*word);
+        if (analysis.files.contains(path) && macro != analysis.macros.end()) {
+            return macro->second;
+        }
+    }
+    return std::nullopt;
+}
+
+/// Requests
+
+Json LanguageServer::initialize() {
+    Json result = Json::makeObject();
+    Json& capabilities = result["capabilities"];
+    capabilities["textDocumentSync"]["openClose"] = true;
+    capabilities["textDocumentSync"]["change"] = textDocumentSyncFull;
+    capabilities["definitionProvider"] = true;
+    capabilities["hoverProvider"] = true;
+    capabilities["documentSymbolProvider"] = true;
+    result["serverInfo"]["name"] = "aspdr";
+    return result;
+}
+
+Json LanguageServer::hover(const Json& params) const {
+    auto path = uriToPath(params["textDocument"]["uri"].string);
+    auto line = params["position"]["line"].getInteger();
+    auto column = params["position"]["character"].getInteger();
+    if (!path || !line || !column) {
+        return Json{};
+    }
+
+    auto symbol = this->findSymbol(*path, *line, *column);
+    if (!symbol) {
+        return Json{};
+    }
+
+    std::stringstream ss{};
+    ss << symbol->first
+        << std::format(" = {:#06x} ({})", symbol->second->value, symbol->second->value);
+
+    Json result = Json::makeObject();
+    result["contents"]["kind"] = "plaintext";
+    result["contents"]["value"] = ss.str();
+    return result;
+}
+
+Json LanguageServer::definition(const Json& params) const {
+    auto path = uriToPath(params["textDocument"]["uri"].string);
+    auto line = params["position"]["line"].getInteger();
+    auto column = params["position"]["character"].getInteger();
+    if (!path || !line || !column) {
+        return Json{};
+    }
+
+    auto position = this->findDefinition(*path, *line, *column);
+    if (!position) {
+        return Json{};
+    }
+    return locationToJson(*position);
+}
+
+Json LanguageServer::documentSymbols(const Json& params) const {
+    Json result = Json::makeArray();
+
+    auto path = uriToPath(params["textDocument"]["uri"].string);
+    if (!path) {
+        return result;
+    }
+
+    std::set<Identifier> seen{};
+    for (const auto& analysis : this->analyses) {
+        for (const auto& symbol : analysis.symbols) {
+            if (symbol.second.position.path != *path
+                || !seen.insert(symbol.first).second
+            ) {
+                continue;
+            }
+
+            std::stringstream name{};
+            name << symbol.first;
+
+            Json entry = Json::makeObject();
+            entry["name"] = name.str();
+            entry["detail"] = std::format("{:#06x}", symbol.second.value);
+            entry["kind"] = symbol.second.label
+                ? symbolKindFunction
+                : symbolKindConstant;
+            entry["range"] = rangeToJson(symbol.second.position);
+            entry["selectionRange"] = rangeToJson(symbol.second.position);
+            result.push(std::move(entry));
+        }
+    }
+    return result;
+}
+
+/// Notifications
+
+void LanguageServer::openDocument(const Json& params) {
+    auto path = uriToPath(params["textDocument"]["uri"].string);
+    auto text = params["textDocument"]["text"].getString();
+    if (!path || !text) {
+        return;
+    }
+
+    this->fileProvider.setFile(*path, std::move(*text));
+    this->documents.insert(*path);
+    this->stale = true;
+}
+
+void LanguageServer::changeDocument(const Json& params) {
+    auto path = uriToPath(params["textDocument"]["uri"].string);
+    const auto& changes = params["contentChanges"].array;
+    if (!path || changes.empty()) {
+        return;
+    }
+
+    // Documents are synchronised whole, so the last change has all of it.
+    auto text = changes.back()["text"].getString();
+    if (!text) {
+        return;
+    }
+
+    this->fileProvider.setFile(*path, std::move(*text));
+    this->stale = true;
+}
+
+void LanguageServer::closeDocument(const Json& params) {
+    auto path = uriToPath(params["textDocument"]["uri"].string);
+    if (!path) {
+        return;
+    }
+
+    this->fileProvider.removeFile(*path);
+    this->documents.erase(*path);
+    this->stale = true;
+}
+
+std::optional<int> LanguageServer::handle(const Json& message) {
+    auto method = message["method"].getString();
+    const Json& id = message["id"];
+    const Json& params = message["params"];
+    bool isRequest = !id.isNull();
+
+    if (!method) {
+        // Responses to requests we never make.
+        return std::nullopt;
+    }
+
+    if (*method == "exit") {
+        return this->shuttingDown ? 0 : 1;
+    }
+
+    if (this->shuttingDown && isRequest) {
+        this->respondError(id, invalidRequest, "server is shutting down");
+        return std::nullopt;
+    }
+
+    if (*method == "initialize") {
+        this->respond(id, this->initialize());
+        this->stale = true;
+    } else if (*method == "shutdown") {
+        this->shuttingDown = true;
+        this->respond(id, Json{});
+    } else if (*method == "textDocument/didOpen") {
+        this->openDocument(params);
+    } else if (*method == "textDocument/didChange") {
+        this->changeDocument(params);
+    } else if (*method == "textDocument/didClose") {
+        this->closeDocument(params);
+    } else if (*method == "textDocument/didSave") {
+        // Files on disk are checked for changes before each assembly.
+        this->stale = true;
+    } else if (*method == "textDocument/hover") {
+        this->respond(id, this->hover(params));
+    } else if (*method == "textDocument/definition") {
+        this->respond(id, this->definition(params));
+    } else if (*method == "textDocument/documentSymbol") {
+        this->respond(id, this->documentSymbols(params));
+    } else if (isRequest) {
+        this->respondError(id, methodNotFound, std::format("unknown method '{}'", *method));
+    }
+    return std::nullopt;
+}
+
+int LanguageServer::run(int inputFd) {
+    MessageReader reader{inputFd};
+
+    for (;;) {
+        // Edits often come in bursts, so assemble once they have all been
+        // read rather than after each one.
+        if (this->stale && !reader.hasPending()) {
+            try {
+                this->analyze();
+            } catch (const std::exception& exception) {
+                this->errors << exception.what() << '\n';
+            }
+        }
+
+        auto body = reader.read();
+        if (!body) {
+            return 1;
+        }
+
+        auto parsed = Json::parse(*body);
+        if (!parsed) {
+            this->respondError(Json{}, parseError, "invalid message");
+            continue;
+        }
+
+        const Json& message = *parsed;
+        const Json& id = message["id"];
+
+        try {
+            // Requests are answered from the latest edits.
+            if (this->stale && !id.isNull()) {
+                this->analyze();
+            }
+
+            auto status = this->handle(message);
+            if (status) {
+                return *status;
+            }
+        } catch (const std::exception& exception) {
+            this->errors << exception.what() << '\n';
+            if (!id.isNull()) {
+                this->respondError(id, internalError, exception.what());
+            }
+        }
+    }
+}
+
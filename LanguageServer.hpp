@@ -0,0 +1,142 @@
+#ifndef LANGUAGESERVER_HPP
+#define LANGUAGESERVER_HPP
+
+#include "Assembler.hpp"
+#include "FileProvider.hpp"
+#include "Identifier.hpp"
+#include "Json.hpp"
+#include "ParseCache.hpp"
+#include <SpdrFirmware/InstructionSet.hpp>
+#include <cstdint>
+#include <iostream>
+#include <map>
+#include <optional>
+#include <set>
+#include <string>
+#include <vector>
+
+// A position in a source file, with lines and columns counted from 0 as
+// the protocol does.
+class SourcePosition {
+public:
+    std::string path;
+    int line;
+    int column;
+};
+
+class SourceSymbol {
+public:
+    std::int64_t value;
+    bool label;
+    SourcePosition position;
+};
+
+// What the last assembly of one program found.
+class Analysis {
+public:
+    std::string root;
+
+    // Absolute paths of the files the program read.
+    std::set<std::string> files;
+
+    std::map<Identifier, SourceSymbol> symbols;
+    std::map<std::string, SourcePosition> macros;
+
+    // Diagnostics by the absolute path of the file they are in.
+    std::map<std::string, std::vector<Json>> diagnostics;
+};
+
+// Serves the language server protocol. Parsed files, including the unsaved
+// documents of the editor, stay in the parse cache so that an edit only
+// parses the edited file again before reassembling.
+class LanguageServer {
+private:
+    std::ostream& output;
+    std::ostream& errors;
+
+    const InstructionSet instructionSet;
+    OverlayFileProvider fileProvider;
+    ParseCache parseCache;
+    Assembler assembler;
+
+    // Programs to assemble. Without any, each open document which is not
+    // included by another is assembled on its own.
+    const std::vector<std::string> roots;
+
+    std::set<std::string> documents;
+    std::vector<Analysis> analyses;
+    std::set<std::string> publishedFiles;
+
+    bool stale;
+    bool shuttingDown;
+
+    void send(const Json& message);
+    void respond(const Json& id, Json result);
+    void respondError(const Json& id, int code, const std::string& message);
+    void notify(const std::string& method, Json params);
+
+    // Absolute path of the file locations with `fileName` refer to.
+    std::string getSourcePath(const std::string& fileName) const;
+
+    SourcePosition getSourcePosition(
+        const yy::position& position,
+        const std::string& defaultPath
+    ) const;
+
+    Analysis analyzeRoot(const std::string& root);
+    void analyze();
+    void publishDiagnostics();
+
+    std::optional<std::string> getWord(
+        const std::string& path,
+        int line,
+        int column
+    ) const;
+
+    // Finds the symbol named at a position, qualifying local names with
+    // the label they follow.
+    std::optional<std::pair<Identifier, const SourceSymbol*>> findSymbol(
+        const std::string& path,
+        int line,
+        int column
+    ) const;
+
+    std::optional<SourcePosition> findDefinition(
+        const std::string& path,
+        int line,
+        int column
+    ) const;
+
+    Json initialize();
+    Json hover(const Json& params) const;
+    Json definition(const Json& params) const;
+    Json documentSymbols(const Json& params) const;
+
+    void openDocument(const Json& params);
+    void changeDocument(const Json& params);
+    void closeDocument(const Json& params);
+
+    // Handles one message, returning the exit status once the client asks
+    // the server to exit.
+    std::optional<int> handle(const Json& message);
+
+public:
+    LanguageServer(
+        SectionMode sectionMode,
+        std::vector<std::string> includePath,
+        std::optional<std::string> prelude,
+        std::map<Identifier, std::int64_t> definitions,
+        std::vector<std::string> roots,
+        std::ostream& output,
+        std::ostream& errors
+    );
+
+    LanguageServer(const LanguageServer&) = delete;
+    LanguageServer& operator=(const LanguageServer&) = delete;
+
+    // Serves messages read from `inputFd` until the client exits.
+    int run(int inputFd);
+};
+
+#endif
+
@@ -0,0 +1,107 @@
+#include "Library.hpp"
+#include "Context.hpp"
+#include <sstream>
+
+AssemblyOptions::AssemblyOptions()
+:   sectionMode{SectionMode::ROM},
+    includePath{},
+    prelude{},
+    definitions{},
+    relocatable{false},
+    eliminateRoutines{false},
+    entryPoints{} {}
+
+AssemblyResult::AssemblyResult()
+:   success{false},
+    sections{},
+    object{},
+    symbols{},
+    diagnostics{},
+    suppressedErrors{0},
+    dependencies{},
+    report{} {}
+
+
+AssemblerSession::AssemblerSession(
+    const AssemblyOptions& options,
+    const FileProvider* fileProvider
+)
+:   instructionSet{},
+    parseCache{options.includePath, fileProvider},
+    assembler{options.sectionMode, instructionSet, parseCache, options.prelude}
+{
+    std::map<Identifier, std::int64_t> definitions{};
+    for (const auto& definition : options.definitions) {
+        definitions[UnqualifiedIdentifier::fromString(definition.first).identifier]
+            = definition.second;
+    }
+
+    this->assembler.setDefinitions(definitions);
+    this->assembler.setRelocatable(options.relocatable);
+    this->assembler.setRoutineElimination(
+        options.eliminateRoutines,
+        options.entryPoints
+    );
+}
+
+Diagnostic getDiagnostic(const Error& error) {
+    Diagnostic diagnostic{
+        error.level,
+        error.code,
+        error.getMessage(),
+        std::nullopt,
+        0,
+        0
+    };
+
+    if (error.location) {
+        const auto& begin = error.location->begin;
+        if (begin.filename) {
+            diagnostic.fileName = *begin.filename;
+        }
+        diagnostic.line = begin.line;
+        diagnostic.column = begin.column;
+    }
+    return diagnostic;
+}
+
+AssemblyResult AssemblerSession::assemble(const std::string& fileName) {
+    AssemblyResult result{};
+
+    this->parseCache.refresh();
+
+    std::stringstream report{};
+    Context context = this->assembler.build(fileName, report);
+
+    result.report = report.str();
+    result.dependencies = context.dependencies;
+    result.suppressedErrors = context.getSuppressedErrors();
+    for (const auto& error : context.getErrors()) {
+        result.diagnostics.push_back(getDiagnostic(error));
+    }
+
+    for (const auto& symbol : this->assembler.getSymbols()) {
+        std::stringstream ss{};
+        ss << symbol.first;
+        result.symbols[ss.str()] = symbol.second;
+    }
+
+    result.success = !context.hasErrors();
+    if (!result.success) {
+        return result;
+    }
+
+    if (this->assembler.isRelocatable()) {
+        result.object = this->assembler.getObjectFile(context);
+        return result;
+    }
+
+    for (const auto& section : context.sections) {
+        if (section.second.isWritable()) {
+            auto bytes = section.second.getBytes();
+            result.sections[section.first] = {bytes.begin(), bytes.end()};
+        }
+    }
+    return result;
+}
+
@@ -0,0 +1,88 @@
+#ifndef LIBRARY_HPP
+#define LIBRARY_HPP
+
+#include "Assembler.hpp"
+#include "Error.hpp"
+#include "FileProvider.hpp"
+#include "ObjectFile.hpp"
+#include "ParseCache.hpp"
+#include <SpdrFirmware/InstructionSet.hpp>
+#include <cstdint>
+#include <map>
+#include <optional>
+#include <set>
+#include <string>
+#include <vector>
+
+// Interface of libaspdr, for programs which assemble without going through
+// the command line or the file system.
+
+class Diagnostic {
+public:
+    Error::Level level;
+    Error::Code code;
+    std::string message;
+
+    // Position of the error, if it has one.
+    std::optional<std::string> fileName;
+    int line;
+    int column;
+};
+
+class AssemblyOptions {
+public:
+    SectionMode sectionMode;
+    std::vector<std::string> includePath;
+    std::optional<std::string> prelude;
+    std::map<std::string, std::int64_t> definitions;
+    bool relocatable;
+    bool eliminateRoutines;
+    std::set<std::string> entryPoints;
+
+    AssemblyOptions();
+};
+
+class AssemblyResult {
+public:
+    bool success;
+
+    // Bytes of each writable section. Empty for relocatable builds, which
+    // produce `object` instead.
+    std::map<std::string, std::vector<char>> sections;
+    std::optional<ObjectFile> object;
+
+    std::map<std::string, std::int64_t> symbols;
+    std::vector<Diagnostic> diagnostics;
+    std::size_t suppressedErrors;
+    std::set<std::string> dependencies;
+
+    // Notes about the build, such as removed routines.
+    std::string report;
+
+    AssemblyResult();
+};
+
+// Assembles programs read through a file provider, which defaults to the
+// disk. Parsed files are kept between calls and parsed again when the
+// provider reports a change. Sessions are independent and may be used on
+// different threads at once; calls on one session must not overlap.
+class AssemblerSession {
+private:
+    const InstructionSet instructionSet;
+    ParseCache parseCache;
+    Assembler assembler;
+
+public:
+    AssemblerSession(
+        const AssemblyOptions& options,
+        const FileProvider* fileProvider = nullptr
+    );
+
+    AssemblerSession(const AssemblerSession&) = delete;
+    AssemblerSession& operator=(const AssemblerSession&) = delete;
+
+    AssemblyResult assemble(const std::string& fileName);
+};
+
+#endif
+
@@ -0,0 +1,183 @@
+#include "Listing.hpp"
+#include "Assembler.hpp"
+#include "Context.hpp"
+#include <algorithm>
+#include <format>
+#include <iterator>
+#include <map>
+#include <string_view>
+#include <vector>
+
+int getCycles(const MicroSequence& micros) {
+    return static_cast<int>(micros.sequence.size());
+}
+
+// The lines of a source file, read when the listing first refers to it.
+class ListingSource {
+public:
+    std::string contents;
+    std::vector<std::string_view> lines;
+};
+
+const ListingSource& getListingSource(
+    const Context& context,
+    std::map<const std::string*, ListingSource>& sources,
+    const std::string* fileName
+) {
+    auto found = sources.find(fileName);
+    if (found != sources.end()) {
+        return found->second;
+    }
+
+    ListingSource& source = sources[fileName];
+    const ParseCache& parseCache = context.assembler->parseCache;
+    auto path = parseCache.getPath(*fileName);
+    auto contents = path ? parseCache.getFileProvider().read(*path) : std::nullopt;
+    if (!contents) {
+        return source;
+    }
+
+    source.contents = std::move(*contents);
+    std::string_view text{source.contents};
+    while (!text.empty()) {
+        auto end = text.find('\n');
+        source.lines.push_back(text.substr(0, end));
+        if (end == std::string_view::npos) {
+            break;
+        }
+        text.remove_prefix(end + 1);
+    }
+    return source;
+}
+
+void writeListing(const Context& context, std::ostream& stream) {
+    const std::size_t bytesPerLine = 4;
+    const std::size_t flushSize = 1 << 16;
+
+    std::map<const std::string*, ListingSource> sources{};
+    const std::string* currentFile = nullptr;
+    std::int64_t total = 0;
+
+    // Lines are formatted into one buffer which is written out in blocks.
+    std::string buffer{};
+    auto out = std::back_inserter(buffer);
+
+    for (const auto& line : context.listingLines) {
+        const std::string* fileName = line.location.begin.filename;
+        if (fileName && fileName != currentFile) {
+            std::format_to(out, "; {}\n", *fileName);
+            currentFile = fileName;
+        }
+
+        if (line.label) {
+            total = 0;
+        }
+        if (line.cycles) {
+            total += *line.cycles;
+        }
+
+        std::string_view text{};
+        int lineNumber = line.location.begin.line;
+        if (fileName) {
+            const auto& lines = getListingSource(context, sources, fileName).lines;
+            if (lineNumber >= 1 && static_cast<std::size_t>(lineNumber) <= lines.size()) {
+                text = lines[lineNumber - 1];
+            }
+        }
+
+        auto bytes = context.sections.at(line.section).getBytes();
+        std::size_t end = std::min(line.offset + line.size, bytes.size());
+
+        // The first row has the source line, and further rows the rest of
+        // the bytes.
+        std::size_t i = line.offset;
+        do {
+            if (line.address) {
+                std::format_to(out, "{:04x}  ", *line.address + (i - line.offset));
+            } else {
+                std::format_to(out, "????  ");
+            }
+
+            std::size_t rowEnd = std::min(i + bytesPerLine, end);
+            for (std::size_t j = i; j < i + bytesPerLine; ++j) {
+                if (j < rowEnd) {
+                    std::format_to(out, "{:02x} ", static_cast<std::uint8_t>(bytes[j]));
+                } else {
+                    buffer += "   ";
+                }
+            }
+
+            if (i == line.offset) {
+                if (line.cycles) {
+                    std::format_to(out, " {:>4} {:>6}", *line.cycles, total);
+                } else {
+                    buffer += "            ";
+                }
+                std::format_to(out, "  {:>5}  {}", lineNumber, text);
+            }
+            buffer += '\n';
+            i = rowEnd;
+        } while (i < end);
+
+        if (buffer.size() >= flushSize) {
+            stream.write(buffer.data(), buffer.size());
+            buffer.clear();
+        }
+    }
+    stream.write(buffer.data(), buffer.size());
+}
+
+void checkCycleBudgets(Context& context) {
+    for (const auto& budget : context.cycleBudgets) {
+        std::int64_t total = 0;
+        const ListingLine* over = nullptr;
+        const ListingLine* backward = nullptr;
+        for (const auto& line : context.listingLines) {
+            if (!line.cycles || !line.address
+                || *line.address < budget.start || *line.address >= budget.end
+            ) {
+                continue;
+            }
+
+            total += *line.cycles;
+            if (!over && total > budget.max) {
+                over = &line;
+            }
+            if (!backward && line.target
+                && *line.target >= budget.start && *line.target < *line.address
+            ) {
+                backward = &line;
+            }
+        }
+
+        if (backward) {
+            context.error(
+                Error::Level::Fatal,
+                std::format(
+                    "cycle budget region {:04x} to {:04x} branches backwards "
+                    "at line {}, so its cycles cannot be bounded",
+                    budget.start,
+                    budget.end,
+                    backward->location.begin.line
+                ),
+                budget.location
+            );
+        } else if (over) {
+            context.error(
+                Error::Level::Fatal,
+                std::format(
+                    "cycle budget exceeded: {:04x} to {:04x} takes {} cycles "
+                    "(max {}), going over at line {}",
+                    budget.start,
+                    budget.end,
+                    total,
+                    budget.max,
+                    over->location.begin.line
+                ),
+                budget.location
+            );
+        }
+    }
+}
+
+
@@ -0,0 +1,60 @@
+#ifndef LISTING_HPP
+#define LISTING_HPP
+
+#include "Location.hpp"
+#include <SpdrFirmware/MicroSequence.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <optional>
+#include <string>
+
+class Context;
+
+// The output of one statement of the final pass, recorded while listing.
+// The bytes themselves stay in the section until the listing is written.
+class ListingLine {
+public:
+    std::string section;
+    std::optional<std::int64_t> address;
+    std::size_t offset;
+    std::size_t size;
+    Location location;
+
+    // Instructions only. The target is the value of the first immediate
+    // word operand, which is where a jump goes.
+    std::optional<int> cycles;
+    std::optional<std::int64_t> target;
+
+    // Labels start a new running cycle total.
+    bool label;
+};
+
+// A region of code which must run within `max` cycles, from an
+// `assert_cycles` directive.
+class CycleBudget {
+public:
+    Location location;
+    std::int64_t start;
+    std::int64_t end;
+    std::int64_t max;
+};
+
+// Clock cycles an instruction takes, one per step of its micro-sequence.
+int getCycles(const MicroSequence& micros);
+
+// Adds a fatal error at each budget in `context` its region goes over. The
+// cycles of every instruction in the region are added up, which is the
+// count of straight-line code and the most any path through the region
+// takes if it never branches backwards. A region with an instruction
+// targeting an earlier address in the region may loop, so it is an error
+// too.
+void checkCycleBudgets(Context& context);
+
+// Writes the lines recorded in `context` with their address, bytes, cycles,
+// the running cycle total since the last label, and the source line. Source
+// files are read again as the lines refer to them.
+void writeListing(const Context& context, std::ostream& stream);
+
+#endif
+
@@ -19,6 +19,19 @@ bool MacroStatement::assemble(Context& context) {
     return context.addMacro(this);
 }
 
+void MacroStatement::addMemoryUsage(MemoryTallies& usage) const {
+    std::uint64_t bytes = sizeof(*this)
+        + getHeapSize(this->name)
+        + getHeapSize(this->parameters);
+    for (const auto& parameter : this->parameters) {
+        if (parameter.second) {
+            bytes += getHeapSize(*parameter.second);
+        }
+    }
+    usage["MacroStatement"].add(bytes);
+    this->block->addMemoryUsage(usage);
+}
+
 bool MacroStatement::assembleBlock(
     Context& context,
     const std::vector<Expression*>& arguments,
@@ -29,6 +42,8 @@ bool MacroStatement::assembleBlock(
         "parameter count does not match passed argument count"
     );
 
+    ProfileSpan span{context.profiler, "macro", this->name};
+
     context.frames.push({Frame::Type::Macro, id});
 
     for (std::size_t i = 0; i < arguments.size(); ++i) {
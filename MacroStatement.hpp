@@ -21,6 +21,7 @@ public:
     virtual ~MacroStatement() override;
 
     virtual bool assemble(Context& context) override;
+    virtual void addMemoryUsage(MemoryTallies& usage) const override;
     bool assembleBlock(Context& context, const std::vector<Expression*>& arguments, int id);
 
     Instruction getInstruction();
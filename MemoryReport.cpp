@@ -0,0 +1,70 @@
+#include "MemoryReport.hpp"
+#include <format>
+#include <sys/resource.h>
+
+void MemoryTally::add(std::uint64_t bytes, std::uint64_t count) {
+    this->count += count;
+    this->bytes += bytes;
+}
+
+
+MemoryReport::MemoryReport() : categories{} {}
+
+void MemoryReport::write(std::ostream& stream) const {
+    stream << std::format("{:<40} {:>10} {:>14}\n", "memory", "count", "bytes");
+
+    std::uint64_t accounted = 0;
+    for (const auto& category : this->categories) {
+        MemoryTally total{0, 0};
+        for (const auto& kind : category.second) {
+            total.add(kind.second.bytes, kind.second.count);
+        }
+        accounted += total.bytes;
+
+        stream << std::format(
+            "{:<40} {:>10} {:>14}\n",
+            category.first,
+            total.count,
+            total.bytes
+        );
+        for (const auto& kind : category.second) {
+            stream << std::format(
+                "  {:<38} {:>10} {:>14}\n",
+                kind.first,
+                kind.second.count,
+                kind.second.bytes
+            );
+        }
+    }
+
+    stream << std::format("{:<40} {:>10} {:>14}\n", "accounted", "", accounted);
+
+    // Linux gives the peak in KiB.
+    rusage usage{};
+    if (getrusage(RUSAGE_SELF, &usage) == 0) {
+        stream << std::format(
+            "{:<40} {:>10} {:>14}\n",
+            "peak resident set",
+            "",
+            static_cast<std::uint64_t>(usage.ru_maxrss) * 1024
+        );
+    }
+}
+
+
+std::uint64_t getHeapSize(const std::string& string) {
+    const char* begin = reinterpret_cast<const char*>(&string);
+    if (string.data() >= begin && string.data() < begin + sizeof(string)) {
+        return 0;
+    }
+    return string.capacity() + 1;
+}
+
+std::uint64_t getHeapSize(const Identifier& identifier) {
+    std::uint64_t bytes = getHeapSize(identifier.value);
+    for (const auto& part : identifier.value) {
+        bytes += getHeapSize(part);
+    }
+    return bytes;
+}
+
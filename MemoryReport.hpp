@@ -0,0 +1,53 @@
+#ifndef MEMORYREPORT_HPP
+#define MEMORYREPORT_HPP
+
+#include "Identifier.hpp"
+#include <cstdint>
+#include <iostream>
+#include <map>
+#include <string>
+#include <vector>
+
+// How many objects of one kind there are and the bytes they take, counting
+// what they own on the heap.
+class MemoryTally {
+public:
+    std::uint64_t count;
+    std::uint64_t bytes;
+
+    void add(std::uint64_t bytes, std::uint64_t count = 1);
+};
+
+// Tallies by kind, such as the statements of a file by class.
+using MemoryTallies = std::map<std::string, MemoryTally>;
+
+// Where the memory of a build goes, for --mem-report. The sizes are what
+// the objects ask the allocator for, so they leave out its overhead and
+// anything not accounted, which the peak resident set size includes.
+class MemoryReport {
+public:
+    // Tallies by category, such as the syntax tree of one file.
+    std::map<std::string, MemoryTallies> categories;
+
+    MemoryReport();
+
+    void write(std::ostream& stream) const;
+};
+
+// Bytes `string` holds outside of itself, which is none for short strings.
+std::uint64_t getHeapSize(const std::string& string);
+
+std::uint64_t getHeapSize(const Identifier& identifier);
+
+template<typename T>
+std::uint64_t getHeapSize(const std::vector<T>& vector) {
+    return vector.capacity() * sizeof(T);
+}
+
+// The node holding `T` in a std::map or std::set, which adds three links
+// and a colour.
+template<typename T>
+constexpr std::uint64_t treeNodeSize = sizeof(T) + 4 * sizeof(void*);
+
+#endif
+
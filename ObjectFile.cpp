@@ -0,0 +1,133 @@
+#include "ObjectFile.hpp"
+#include <algorithm>
+#include <map>
+
+// Object files are a header line followed by one line per record. Section
+// contents follow their record line as raw bytes.
+
+const char* const objectMagic = "aspdr-object";
+const int objectVersion = 1;
+
+const std::map<Size, std::string> relocationSizes{
+    {Size::Word, "word"},
+    {Size::Byte, "byte"},
+    {Size::Page, "page"},
+};
+
+void ObjectFile::write(std::ostream& stream) const {
+    stream << objectMagic << ' ' << objectVersion << '\n';
+
+    for (const auto& section : this->sections) {
+        stream
+            << "section " << section.name << ' '
+            << section.size << ' '
+            << section.bytes.size() << '\n';
+        stream.write(section.bytes.data(), section.bytes.size());
+        stream << '\n';
+    }
+
+    for (const auto& symbol : this->exports) {
+        stream
+            << "export " << symbol.name << ' '
+            << symbol.section.value_or("-") << ' '
+            << symbol.value << '\n';
+    }
+
+    for (const auto& name : this->imports) {
+        stream << "import " << name << '\n';
+    }
+
+    for (const auto& relocation : this->relocations) {
+        stream
+            << "relocation " << relocation.section << ' '
+            << relocation.offset << ' '
+            << relocationSizes.at(relocation.size) << ' '
+            << (relocation.base.external ? "import " : "section ")
+            << relocation.base.name << ' '
+            << relocation.addend << '\n';
+    }
+}
+
+std::optional<ObjectFile> ObjectFile::read(std::istream& stream) {
+    std::string magic{};
+    int version;
+    if (!(stream >> magic >> version)
+        || magic != objectMagic
+        || version != objectVersion
+    ) {
+        return std::nullopt;
+    }
+
+    ObjectFile object{};
+    std::string record{};
+    while (stream >> record) {
+        if (record == "section") {
+            ObjectSection section{};
+            std::size_t count;
+            if (!(stream >> section.name >> section.size >> count)
+                || stream.get() != '\n'
+            ) {
+                return std::nullopt;
+            }
+
+            section.bytes.resize(count);
+            stream.read(section.bytes.data(), count);
+            if (!stream) {
+                return std::nullopt;
+            }
+            object.sections.push_back(std::move(section));
+        } else if (record == "export") {
+            ObjectSymbol symbol{};
+            std::string section{};
+            if (!(stream >> symbol.name >> section >> symbol.value)) {
+                return std::nullopt;
+            }
+            if (section != "-") {
+                symbol.section = section;
+            }
+            object.exports.push_back(std::move(symbol));
+        } else if (record == "import") {
+            std::string name{};
+            if (!(stream >> name)) {
+                return std::nullopt;
+            }
+            object.imports.push_back(std::move(name));
+        } else if (record == "relocation") {
+            Relocation relocation{};
+            std::string size{};
+            std::string kind{};
+            if (!(stream
+                >> relocation.section
+                >> relocation.offset
+                >> size
+                >> kind
+                >> relocation.base.name
+                >> relocation.addend
+            )) {
+                return std::nullopt;
+            }
+
+            auto found = std::find_if(
+                relocationSizes.begin(),
+                relocationSizes.end(),
+                [&](const auto& entry) { return entry.second == size; }
+            );
+            if (found == relocationSizes.end()
+                || (kind != "import" && kind != "section")
+            ) {
+                return std::nullopt;
+            }
+            relocation.size = found->first;
+            relocation.base.external = kind == "import";
+            object.relocations.push_back(std::move(relocation));
+        } else {
+            return std::nullopt;
+        }
+    }
+
+    if (!stream.eof()) {
+        return std::nullopt;
+    }
+    return object;
+}
+
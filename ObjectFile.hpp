@@ -0,0 +1,64 @@
+#ifndef OBJECTFILE_HPP
+#define OBJECTFILE_HPP
+
+#include <SpdrFirmware/Mode.hpp>
+#include <compare>
+#include <cstdint>
+#include <iostream>
+#include <optional>
+#include <string>
+#include <vector>
+
+// What a relocatable value is relative to: the start of a section of the
+// module being assembled, or an imported symbol.
+class RelocationBase {
+public:
+    std::string name;
+    bool external;
+
+    auto operator<=>(const RelocationBase& other) const = default;
+};
+
+// An operand which is only known once the module has been placed. The
+// linker writes the address of `base` plus `addend` at `offset` in
+// `section`, encoded as `size`.
+class Relocation {
+public:
+    std::string section;
+    std::int64_t offset;
+    Size size;
+    RelocationBase base;
+    std::int64_t addend;
+};
+
+class ObjectSection {
+public:
+    std::string name;
+    std::int64_t size;
+    std::vector<char> bytes;
+};
+
+class ObjectSymbol {
+public:
+    std::string name;
+    std::int64_t value;
+
+    // Section the value is an offset into, absolute if empty.
+    std::optional<std::string> section;
+};
+
+// A separately assembled module.
+class ObjectFile {
+public:
+    std::vector<ObjectSection> sections;
+    std::vector<ObjectSymbol> exports;
+    std::vector<std::string> imports;
+    std::vector<Relocation> relocations;
+
+    void write(std::ostream& stream) const;
+
+    static std::optional<ObjectFile> read(std::istream& stream);
+};
+
+#endif
+
@@ -0,0 +1,251 @@
+#include "OutputCache.hpp"
+#include <link.h>
+#include <unistd.h>
+#include <algorithm>
+#include <format>
+#include <fstream>
+#include <functional>
+#include <sstream>
+#include <system_error>
+#include <thread>
+#include <utility>
+#include <vector>
+
+// Changes with the layout of entries.
+const char* const cacheVersion = "aspdr-cache 3";
+
+// Identifies the code producing outputs, so that entries never outlive it:
+// the contents of the running executable and of the firmware library,
+// which is in the executable if linked statically. Computed once.
+const std::string& getBuildId() {
+    static const std::string buildId = [] {
+        std::stringstream ss{};
+        ss << std::format("{:016x}", hashFile("/proc/self/exe"));
+
+        dl_iterate_phdr([](dl_phdr_info* info, std::size_t, void* data) {
+            std::string_view name{info->dlpi_name};
+            if (name.find("spdr-firmware") != std::string_view::npos) {
+                *static_cast<std::stringstream*>(data)
+                    << std::format(" {:016x}", hashFile(std::string{name}));
+            }
+            return 0;
+        }, &ss);
+        return ss.str();
+    }();
+    return buildId;
+}
+
+OutputCache::OutputCache(std::filesystem::path directory)
+: directory{directory} {}
+
+std::string OutputCache::getKey(
+    const Assembler& assembler,
+    const std::string& fileName
+) const {
+    std::stringstream ss{};
+    ss << cacheVersion << '\n'
+        << getBuildId() << '\n'
+        << std::filesystem::current_path().string() << '\n'
+        << fileName << '\n'
+        << (assembler.getSectionMode() == SectionMode::ROM ? "rom" : "ram") << '\n'
+        << (assembler.isRelocatable() ? "object" : "image") << '\n'
+        << assembler.getPrelude().value_or("") << '\n';
+
+    for (const auto& prefix : assembler.parseCache.getIncludePath()) {
+        ss << "include " << prefix << '\n';
+    }
+    for (const auto& definition : assembler.getDefinitions()) {
+        ss << "define " << definition.first << '=' << definition.second << '\n';
+    }
+    // Their contents are checked like any other dependency.
+    for (const auto* database : assembler.getSymbolDatabases()) {
+        ss << "symbols " << database->getPath() << '\n';
+    }
+    if (assembler.isEliminatingRoutines()) {
+        ss << "eliminate routines\n";
+        for (const auto& entryPoint : assembler.getEntryPoints()) {
+            ss << "entry " << entryPoint << '\n';
+        }
+    }
+
+    return ss.str();
+}
+
+std::filesystem::path OutputCache::getEntries(const std::string& key) const {
+    return this->directory / std::format(
+        "{:016x}",
+        std::hash<std::string>{}(key)
+    );
+}
+
+bool readBlob(std::istream& stream, std::string& blob) {
+    std::size_t size;
+    if (!(stream >> size) || stream.get() != '\n') {
+        return false;
+    }
+
+    blob.resize(size);
+    stream.read(blob.data(), size);
+    return stream && stream.get() == '\n';
+}
+
+void writeBlob(std::ostream& stream, const std::string& blob) {
+    stream << blob.size() << '\n' << blob << '\n';
+}
+
+// Reads the entry at `path` if it was stored for `key` and every file it
+// was built from is unchanged. Files are hashed once per lookup, as entries
+// share most of them, and missing files have no hash.
+std::optional<CachedOutput> readEntry(
+    const std::filesystem::path& path,
+    const std::string& key,
+    std::map<std::string, std::optional<std::size_t>>& hashes
+) {
+    std::ifstream stream{path, std::ios::binary};
+    if (!stream) {
+        return std::nullopt;
+    }
+
+    // Directories are named by a hash of the key, which may collide.
+    std::string version{};
+    std::string entryKey{};
+    if (!readBlob(stream, version)
+        || version != cacheVersion
+        || !readBlob(stream, entryKey)
+        || entryKey != key
+    ) {
+        return std::nullopt;
+    }
+
+    CachedOutput output{};
+    std::string section{};
+    while (stream >> section) {
+        if (section == "dependency") {
+            std::size_t hash;
+            std::string dependency{};
+            if (!(stream >> hash) || !readBlob(stream, dependency)) {
+                return std::nullopt;
+            }
+
+            // Stale as soon as any input differs.
+            if (!hashes.contains(dependency)) {
+                hashes[dependency] = std::filesystem::is_regular_file(dependency)
+                    ? std::optional<std::size_t>{hashFile(dependency)}
+                    : std::nullopt;
+            }
+            if (hashes[dependency] != hash) {
+                return std::nullopt;
+            }
+            output.dependencies[dependency] = hash;
+        } else if (section == "image") {
+            if (!readBlob(stream, output.image)) {
+                return std::nullopt;
+            }
+        } else if (section == "symbols") {
+            if (!readBlob(stream, output.symbols)) {
+                return std::nullopt;
+            }
+        } else {
+            return std::nullopt;
+        }
+    }
+
+    return output;
+}
+
+std::optional<CachedOutput> OutputCache::lookup(const std::string& key) const {
+    std::error_code error{};
+    std::filesystem::directory_iterator entries{this->getEntries(key), error};
+    if (error) {
+        return std::nullopt;
+    }
+
+    std::map<std::string, std::optional<std::size_t>> hashes{};
+    for (const auto& entry : entries) {
+        if (entry.path().extension() == ".tmp") {
+            continue;
+        }
+
+        auto output = readEntry(entry.path(), key, hashes);
+        if (output) {
+            return output;
+        }
+    }
+    return std::nullopt;
+}
+
+bool OutputCache::store(const std::string& key, const CachedOutput& output) const {
+    // Older entries of the key are removed beyond this many.
+    const std::size_t maxEntries = 8;
+
+    std::error_code error{};
+    auto entries = this->getEntries(key);
+    if (std::filesystem::is_regular_file(entries, error)) {
+        // Left by a version which kept one entry per key.
+        std::filesystem::remove(entries, error);
+    }
+    std::filesystem::create_directories(entries, error);
+    if (error) {
+        return false;
+    }
+
+    // Entries are named by their inputs, so a build from the same contents
+    // replaces its earlier entry.
+    std::stringstream inputs{};
+    for (const auto& dependency : output.dependencies) {
+        inputs << dependency.first << '\n' << dependency.second << '\n';
+    }
+    std::string name = std::format(
+        "{:016x}",
+        std::hash<std::string>{}(inputs.str())
+    );
+
+    // Written under a unique name and renamed into place so that readers
+    // never see a partial entry. Other processes may share the directory.
+    auto temporary = entries / std::format(
+        "{}.{}.{}.tmp",
+        name,
+        ::getpid(),
+        std::hash<std::thread::id>{}(std::this_thread::get_id())
+    );
+
+    {
+        std::ofstream stream{temporary, std::ios::binary};
+        writeBlob(stream, cacheVersion);
+        writeBlob(stream, key);
+
+        for (const auto& dependency : output.dependencies) {
+            stream << "dependency " << dependency.second << ' ';
+            writeBlob(stream, dependency.first);
+        }
+
+        stream << "image ";
+        writeBlob(stream, output.image);
+        stream << "symbols ";
+        writeBlob(stream, output.symbols);
+
+        if (!stream) {
+            std::filesystem::remove(temporary, error);
+            return false;
+        }
+    }
+
+    std::filesystem::rename(temporary, entries / name, error);
+    if (error) {
+        return false;
+    }
+
+    std::vector<std::pair<std::filesystem::file_time_type, std::filesystem::path>> stored{};
+    for (const auto& entry : std::filesystem::directory_iterator{entries, error}) {
+        if (entry.path().extension() != ".tmp") {
+            stored.push_back({entry.last_write_time(error), entry.path()});
+        }
+    }
+    if (stored.size() > maxEntries) {
+        std::sort(stored.begin(), stored.end());
+        for (std::size_t i = 0; i < stored.size() - maxEntries; ++i) {
+            std::filesystem::remove(stored[i].second, error);
+        }
+    }
+    return true;
+}
@@ -0,0 +1,48 @@
+#ifndef OUTPUTCACHE_HPP
+#define OUTPUTCACHE_HPP
+
+#include "Assembler.hpp"
+#include <cstddef>
+#include <filesystem>
+#include <map>
+#include <optional>
+#include <string>
+
+// Everything a successful run produces.
+class CachedOutput {
+public:
+    std::string image;
+    std::string symbols;
+
+    // Each file the output was built from, and the hash of the contents
+    // the build used.
+    std::map<std::string, std::size_t> dependencies;
+};
+
+// Outputs of previous runs stored in a directory, keyed by the assembler
+// configuration and input file name. Each key keeps the outputs of several
+// sets of input contents, so switching back and forth between branches
+// still hits. An entry is only used if every file it was built from still
+// has the same contents.
+class OutputCache {
+private:
+    const std::filesystem::path directory;
+
+    // The directory holding the entries of `key`.
+    std::filesystem::path getEntries(const std::string& key) const;
+
+public:
+    OutputCache(std::filesystem::path directory);
+
+    // Returns the key for assembling `fileName` with `assembler`, which
+    // names the build of the assembler and every setting affecting the
+    // output.
+    std::string getKey(const Assembler& assembler, const std::string& fileName) const;
+
+    std::optional<CachedOutput> lookup(const std::string& key) const;
+
+    bool store(const std::string& key, const CachedOutput& output) const;
+};
+
+#endif
+
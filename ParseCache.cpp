@@ -0,0 +1,325 @@
+#include "ParseCache.hpp"
+#include "Assembler.hpp"
+#include "Context.hpp"
+#include "Driver.hpp"
+#include "BinarySource.hpp"
+#include "Error.hpp"
+#include <algorithm>
+#include <cstdio>
+
+ParsedFile::ParsedFile()
+:   block{nullptr},
+    errors{},
+    path{},
+    modified{},
+    size{0},
+    hash{0},
+    firstStatementId{0},
+    released{false} {}
+
+
+ParseCache::ParseCache(
+    std::vector<std::string> includePath,
+    const FileProvider* fileProvider
+)
+:   mutex{},
+    parsedFiles{},
+    streaming{false},
+    includePath{includePath},
+    fileProvider{fileProvider ? *fileProvider : getDiskFileProvider()} {}
+
+ParseCache::~ParseCache() {
+    for (auto& parsed : this->parsedFiles) {
+        delete parsed.second.block;
+    }
+}
+
+std::size_t hashFile(const std::string& path) {
+    auto contents = getDiskFileProvider().read(path);
+    return std::hash<std::string>{}(contents.value_or(""));
+}
+
+const ParsedFile* reportParseFailure(
+    Context& context,
+    const ParsedFile& parsedFile,
+    const std::optional<Location>& location
+) {
+    for (const auto& error : parsedFile.errors) {
+        context.error(error);
+    }
+    if (parsedFile.errors.empty()) {
+        context.error(Error::Level::Syntax, "failed to parse file", location);
+    }
+    return nullptr;
+}
+
+const ParsedFile* ParseCache::getParsedFile(
+    Context& context,
+    const std::string& fileName,
+    std::optional<Location> location
+) {
+    std::scoped_lock lock{this->mutex};
+
+    // A released file is parsed again with the statement ids it had.
+    std::optional<int> firstStatementId{};
+
+    auto existing = this->parsedFiles.find(fileName);
+    if (existing != this->parsedFiles.end()) {
+        const ParsedFile& parsedFile = existing->second;
+        if (parsedFile.block) {
+            return &parsedFile;
+        }
+        if (!parsedFile.released) {
+            return reportParseFailure(context, parsedFile, location);
+        }
+        firstStatementId = parsedFile.firstStatementId;
+    }
+
+    //std::cout << fileName << ": " << std::filesystem::exists(fileName) << '\n';
+
+    // Includes finding and reading the file.
+    ProfileSpan parseSpan{context.profiler, "parse", fileName};
+
+    int nextStatementId = Statement::getNextId();
+    if (firstStatementId) {
+        Statement::setNextId(*firstStatementId);
+    }
+    auto restoreStatementIds = [&]() {
+        if (firstStatementId) {
+            Statement::setNextId(std::max(nextStatementId, Statement::getNextId()));
+        }
+    };
+
+    ParsedFile parsedFile{};
+    parsedFile.firstStatementId = Statement::getNextId();
+    FILE* file = stdin;
+    std::string contents{};
+
+    if (fileName != "stdin") {
+        {
+            ProfileSpan resolveSpan{context.profiler, "resolve", fileName};
+            parsedFile.path = getFileName(
+                context,
+                fileName,
+                this->includePath,
+                location,
+                this->fileProvider
+            );
+        }
+        if (!parsedFile.path) {
+            restoreStatementIds();
+            return nullptr;
+        }
+
+        auto status = this->fileProvider.status(*parsedFile.path);
+        auto read = this->fileProvider.read(*parsedFile.path);
+        ASSEMBLER_ASSERT(status && read, "failed to open file");
+
+        contents = std::move(*read);
+        parsedFile.modified = status->modified;
+        parsedFile.size = status->size;
+        parsedFile.hash = std::hash<std::string>{}(contents);
+
+        if (isBinarySource(contents)) {
+            auto entry = this->parsedFiles.try_emplace(fileName).first;
+
+            std::string error{};
+            parsedFile.block = readBinarySource(contents, entry->first, error);
+            restoreStatementIds();
+            if (!parsedFile.block) {
+                // Released entries stay, as locations may refer to them.
+                if (!firstStatementId) {
+                    this->parsedFiles.erase(entry);
+                }
+                context.error(Error::Level::Syntax, error, location);
+                return nullptr;
+            }
+
+            entry->second = parsedFile;
+            return &entry->second;
+        }
+
+        // The scanner reads from a FILE, so the contents are exposed as one.
+        file = fmemopen(contents.data(), contents.size(), "r");
+        ASSEMBLER_ASSERT(file, "failed to open file");
+    }
+
+    // Locations refer to the file name, so it must outlive this call. Files
+    // which fail to parse are kept too, so that their errors can refer to
+    // it and they are not parsed again until they change.
+    auto entry = this->parsedFiles.try_emplace(fileName).first;
+
+    parsedFile.block = this->parseFile(file, entry->first, parsedFile.errors);
+    restoreStatementIds();
+    if (file != stdin) {
+        std::fclose(file);
+    }
+
+    entry->second = parsedFile;
+    if (!parsedFile.block) {
+        return reportParseFailure(context, entry->second, location);
+    }
+    return &entry->second;
+}
+
+Block* ParseCache::parseFile(
+    FILE* file,
+    const std::string& fileName,
+    std::vector<Error>& errors
+) {
+    // The scanner is not reentrant, so only one file is parsed at a time
+    // across all caches.
+    static std::mutex parserMutex{};
+    std::scoped_lock lock{parserMutex};
+
+    Driver driver{fileName};
+    yyin = file;
+
+    if (driver.parseFile()) {
+        errors = std::move(driver.errors);
+        delete driver.parsed;
+        return nullptr;
+    }
+    return driver.parsed;
+}
+
+void ParseCache::refresh() {
+    std::scoped_lock lock{this->mutex};
+
+    for (auto it = this->parsedFiles.begin(); it != this->parsedFiles.end();) {
+        ParsedFile& parsed = it->second;
+
+        bool stale = !parsed.path;
+        if (!stale) {
+            auto status = this->fileProvider.status(*parsed.path);
+
+            if (!status) {
+                stale = true;
+            } else if (status->modified != parsed.modified
+                || status->size != parsed.size
+            ) {
+                auto contents = this->fileProvider.read(*parsed.path);
+                stale = !contents
+                    || std::hash<std::string>{}(*contents) != parsed.hash;
+                parsed.modified = status->modified;
+                parsed.size = status->size;
+            }
+        }
+
+        if (stale) {
+            delete parsed.block;
+            it = this->parsedFiles.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+void ParseCache::setStreaming(bool streaming) {
+    this->streaming = streaming;
+}
+
+bool ParseCache::isStreaming() const {
+    return this->streaming;
+}
+
+// Moves the statements of `block` and its nested blocks which are in `keep`
+// to `detached`, leaving null in their place.
+void detachStatements(
+    Block* block,
+    const std::set<const Statement*>& keep,
+    std::vector<Statement*>& detached
+) {
+    for (auto& statement : block->statements) {
+        if (keep.contains(statement)) {
+            detached.push_back(statement);
+            statement = nullptr;
+        } else if (auto conditional = dynamic_cast<ConditionalStatement*>(statement)) {
+            detachStatements(conditional->body, keep, detached);
+            if (conditional->elseBody) {
+                detachStatements(*conditional->elseBody, keep, detached);
+            }
+        } else if (auto repeat = dynamic_cast<RepeatStatement*>(statement)) {
+            detachStatements(repeat->body, keep, detached);
+        }
+    }
+}
+
+std::vector<Statement*> ParseCache::release(
+    const std::string& fileName,
+    const std::set<const Statement*>& keep
+) {
+    std::scoped_lock lock{this->mutex};
+
+    std::vector<Statement*> detached{};
+    auto parsed = this->parsedFiles.find(fileName);
+    if (parsed == this->parsedFiles.end()
+        || !parsed->second.block
+        || !parsed->second.path
+    ) {
+        return detached;
+    }
+
+    detachStatements(parsed->second.block, keep, detached);
+    delete parsed->second.block;
+    parsed->second.block = nullptr;
+    parsed->second.released = true;
+    return detached;
+}
+
+std::vector<std::string> ParseCache::getParsedPaths() const {
+    std::scoped_lock lock{this->mutex};
+
+    std::vector<std::string> paths{};
+    for (const auto& parsed : this->parsedFiles) {
+        if (parsed.second.path) {
+            paths.push_back(*parsed.second.path);
+        }
+    }
+    return paths;
+}
+
+std::optional<std::string> ParseCache::getPath(const std::string& fileName) const {
+    std::scoped_lock lock{this->mutex};
+
+    auto parsed = this->parsedFiles.find(fileName);
+    if (parsed == this->parsedFiles.end()) {
+        return std::nullopt;
+    }
+    return parsed->second.path;
+}
+
+std::span<const std::string> ParseCache::getIncludePath() const {
+    return this->includePath;
+}
+
+const FileProvider& ParseCache::getFileProvider() const {
+    return this->fileProvider;
+}
+
+void ParseCache::addMemoryUsage(MemoryReport& report) const {
+    std::scoped_lock lock{this->mutex};
+
+    auto& cache = report.categories["parse cache"];
+    for (const auto& parsed : this->parsedFiles) {
+        const ParsedFile& file = parsed.second;
+        cache["entries"].add(
+            treeNodeSize<std::pair<const std::string, ParsedFile>>
+            + getHeapSize(parsed.first)
+            + (file.path ? getHeapSize(*file.path) : 0)
+        );
+
+        if (!file.errors.empty()) {
+            std::uint64_t bytes = getHeapSize(file.errors);
+            for (const auto& error : file.errors) {
+                bytes += getHeapSize(error.message);
+            }
+            cache["syntax errors"].add(bytes, file.errors.size());
+        }
+
+        if (file.block) {
+            file.block->addMemoryUsage(report.categories["ast " + parsed.first]);
+        }
+    }
+}
+
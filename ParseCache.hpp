@@ -0,0 +1,113 @@
+#ifndef PARSECACHE_HPP
+#define PARSECACHE_HPP
+
+#include "Block.hpp"
+#include "Location.hpp"
+#include "FileProvider.hpp"
+#include "Error.hpp"
+#include "MemoryReport.hpp"
+#include <cstdio>
+#include <filesystem>
+#include <map>
+#include <mutex>
+#include <optional>
+#include <set>
+#include <span>
+#include <string>
+#include <vector>
+
+class Context;
+
+std::size_t hashFile(const std::string& path);
+
+class ParsedFile {
+public:
+    // Null if the file failed to parse, in which case `errors` says why.
+    Block* block;
+    std::vector<Error> errors;
+    std::optional<std::string> path;
+    std::filesystem::file_time_type modified;
+    std::uintmax_t size;
+    std::size_t hash;
+
+    // The id of the first statement parsed from the file.
+    int firstStatementId;
+
+    // Streaming only. The syntax tree was dropped after the file was
+    // assembled, and is parsed again the next time it is used.
+    bool released;
+
+    ParsedFile();
+};
+
+// Parsed files for one include path. May be shared by assemblers running
+// on different threads. Files are read through `fileProvider`, which
+// defaults to the disk.
+class ParseCache {
+private:
+    mutable std::mutex mutex;
+    std::map<std::string, ParsedFile> parsedFiles;
+    bool streaming;
+    const std::vector<std::string> includePath;
+    const FileProvider& fileProvider;
+
+    Block* parseFile(
+        FILE* file,
+        const std::string& fileName,
+        std::vector<Error>& errors
+    );
+
+public:
+    ParseCache(
+        std::vector<std::string> includePath,
+        const FileProvider* fileProvider = nullptr
+    );
+    ~ParseCache();
+
+    ParseCache(const ParseCache&) = delete;
+    ParseCache& operator=(const ParseCache&) = delete;
+
+    const ParsedFile* getParsedFile(
+        Context& context,
+        const std::string& fileName,
+        std::optional<Location> location = {}
+    );
+
+    // Drops parsed files which have changed on disk since they were parsed.
+    void refresh();
+
+    // In streaming mode the assembler releases each file once it has been
+    // assembled, so memory is bounded by the files being assembled rather
+    // than by all of the source. A file is parsed whole, so one large file
+    // still takes memory in proportion to its size. Released files are
+    // read again on their next use. Streaming parses rewind statement ids, so a streaming
+    // cache must not be shared between threads.
+    void setStreaming(bool streaming);
+
+    bool isStreaming() const;
+
+    // Drops the syntax tree of `fileName`, keeping what is known about the
+    // file. Statements in `keep`, such as macro definitions still in use,
+    // are taken out of the tree first and returned. Files read from stdin
+    // cannot be read again, so they are kept.
+    std::vector<Statement*> release(
+        const std::string& fileName,
+        const std::set<const Statement*>& keep
+    );
+
+    std::vector<std::string> getParsedPaths() const;
+
+    // Where the file included as `fileName` was found, if it has been read.
+    std::optional<std::string> getPath(const std::string& fileName) const;
+
+    std::span<const std::string> getIncludePath() const;
+
+    const FileProvider& getFileProvider() const;
+
+    // Adds the cache entries, and the syntax tree of each file by file
+    // name, to `report`.
+    void addMemoryUsage(MemoryReport& report) const;
+};
+
+#endif
+
@@ -0,0 +1,147 @@
+#include "Profiler.hpp"
+#include "Json.hpp"
+#include <algorithm>
+#include <format>
+
+Profiler::Profiler(bool tracing)
+:   tracing{tracing},
+    start{ProfileClock::now()},
+    passes{},
+    phases{},
+    spans{},
+    events{} {}
+
+PassProfile& Profiler::beginPass() {
+    int number = static_cast<int>(this->passes.size()) + 1;
+    return this->passes.emplace_back(PassProfile{number, {}, 0, 0, 0, 0});
+}
+
+void Profiler::record(
+    const char* category,
+    std::string_view name,
+    int line,
+    ProfileClock::time_point start,
+    ProfileClock::time_point end
+) {
+    auto duration = end - start;
+    std::string spanName = line > 0
+        ? std::format("{}:{}", name, line)
+        : std::string{name};
+
+    auto& phase = this->phases[category];
+    ++phase.count;
+    phase.time += duration;
+
+    auto& span = this->spans[{category, spanName}];
+    ++span.count;
+    span.time += duration;
+
+    if (this->tracing) {
+        this->events.push_back({category, std::move(spanName), start, duration});
+    }
+}
+
+double getMilliseconds(ProfileClock::duration duration) {
+    return std::chrono::duration<double, std::milli>{duration}.count();
+}
+
+double getMicroseconds(ProfileClock::duration duration) {
+    return std::chrono::duration<double, std::micro>{duration}.count();
+}
+
+void Profiler::writeReport(std::ostream& stream) const {
+    const std::size_t slowestCount = 10;
+
+    stream << std::format("{:<12} {:>8} {:>12}\n", "phase", "count", "time (ms)");
+    stream << std::format(
+        "{:<12} {:>8} {:>12.3f}\n",
+        "total",
+        1,
+        getMilliseconds(ProfileClock::now() - this->start)
+    );
+    for (const auto& phase : this->phases) {
+        stream << std::format(
+            "{:<12} {:>8} {:>12.3f}\n",
+            phase.first,
+            phase.second.count,
+            getMilliseconds(phase.second.time)
+        );
+    }
+
+    stream << std::format(
+        "\n{:<6} {:>12} {:>12} {:>12} {:>12} {:>10}\n",
+        "pass",
+        "time (ms)",
+        "statements",
+        "lookups",
+        "evaluations",
+        "bytes"
+    );
+    for (const auto& pass : this->passes) {
+        stream << std::format(
+            "{:<6} {:>12.3f} {:>12} {:>12} {:>12} {:>10}\n",
+            pass.number,
+            getMilliseconds(pass.time),
+            pass.statements,
+            pass.symbolLookups,
+            pass.evaluations,
+            pass.bytes
+        );
+    }
+
+    // Passes are already listed above.
+    std::vector<decltype(this->spans)::const_pointer> slowest{};
+    for (const auto& span : this->spans) {
+        if (span.first.first != "pass") {
+            slowest.push_back(&span);
+        }
+    }
+    std::sort(slowest.begin(), slowest.end(), [](auto a, auto b) {
+        return a->second.time > b->second.time;
+    });
+    if (slowest.size() > slowestCount) {
+        slowest.resize(slowestCount);
+    }
+    if (slowest.empty()) {
+        return;
+    }
+
+    stream << std::format(
+        "\n{:<10} {:<40} {:>8} {:>12}\n",
+        "slowest",
+        "name",
+        "count",
+        "time (ms)"
+    );
+    for (const auto* span : slowest) {
+        stream << std::format(
+            "{:<10} {:<40} {:>8} {:>12.3f}\n",
+            span->first.first,
+            span->first.second,
+            span->second.count,
+            getMilliseconds(span->second.time)
+        );
+    }
+}
+
+void Profiler::writeTrace(std::ostream& stream) const {
+    Json events = Json::makeArray();
+    for (const auto& event : this->events) {
+        Json json = Json::makeObject();
+        json["name"] = event.name;
+        json["cat"] = event.category;
+        json["ph"] = "X";
+        json["ts"] = getMicroseconds(event.start - this->start);
+        json["dur"] = getMicroseconds(event.duration);
+        json["pid"] = 1;
+        json["tid"] = 1;
+        events.push(std::move(json));
+    }
+
+    Json trace = Json::makeObject();
+    trace["traceEvents"] = std::move(events);
+    trace["displayTimeUnit"] = "ms";
+    trace.write(stream);
+    stream << '\n';
+}
+
@@ -0,0 +1,131 @@
+#ifndef PROFILER_HPP
+#define PROFILER_HPP
+
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <iostream>
+#include <map>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+using ProfileClock = std::chrono::steady_clock;
+
+// What one assembler pass did.
+class PassProfile {
+public:
+    int number;
+    ProfileClock::duration time;
+    std::uint64_t statements;
+    std::uint64_t symbolLookups;
+    std::uint64_t evaluations;
+
+    // The size of every section at the end of the pass.
+    std::uint64_t bytes;
+};
+
+// The total of the spans of one kind, or of one name within a kind.
+class SpanTotal {
+public:
+    std::uint64_t count;
+    ProfileClock::duration time;
+};
+
+class TraceEvent {
+public:
+    const char* category;
+    std::string name;
+    ProfileClock::time_point start;
+    ProfileClock::duration duration;
+};
+
+// Collects where the time of a build goes, for --time-report and --trace.
+// Assembly only reaches the profiler through a pointer which is null when
+// profiling is disabled, so an unprofiled build pays for a null check at
+// each instrumented point and nothing else.
+//
+// Spans are timed inclusively: a macro expanded in an included file counts
+// towards both the include and the macro, and parses count towards the pass
+// which triggered them.
+class Profiler {
+private:
+    const bool tracing;
+    const ProfileClock::time_point start;
+
+    std::deque<PassProfile> passes;
+    std::map<std::string, SpanTotal> phases;
+    std::map<std::pair<std::string, std::string>, SpanTotal> spans;
+    std::vector<TraceEvent> events;
+
+public:
+    // Trace events are only kept with `tracing`; the totals always are.
+    Profiler(bool tracing);
+
+    Profiler(const Profiler&) = delete;
+    Profiler& operator=(const Profiler&) = delete;
+
+    // Starts counting a new pass. The profile stays valid as more are
+    // started.
+    PassProfile& beginPass();
+
+    // Records a span of `category`, such as a macro expansion, named for
+    // what it expanded. Spans of source text also give the `line` they
+    // start on.
+    void record(
+        const char* category,
+        std::string_view name,
+        int line,
+        ProfileClock::time_point start,
+        ProfileClock::time_point end
+    );
+
+    void writeReport(std::ostream& stream) const;
+
+    // Writes the spans in the Chrome trace event format.
+    void writeTrace(std::ostream& stream) const;
+};
+
+// Records the span from its construction to its destruction with
+// `profiler`, if there is one. Defined here so that the disabled case
+// stays a null check where it is used.
+class ProfileSpan {
+private:
+    Profiler* profiler;
+    const char* category;
+    std::string_view name;
+    int line;
+    ProfileClock::time_point start;
+
+public:
+    ProfileSpan(
+        Profiler* profiler,
+        const char* category,
+        std::string_view name,
+        int line = 0
+    )
+    :   profiler{profiler},
+        category{category},
+        name{name},
+        line{line},
+        start{profiler ? ProfileClock::now() : ProfileClock::time_point{}} {}
+
+    ~ProfileSpan() {
+        if (this->profiler) {
+            this->profiler->record(
+                this->category,
+                this->name,
+                this->line,
+                this->start,
+                ProfileClock::now()
+            );
+        }
+    }
+
+    ProfileSpan(const ProfileSpan&) = delete;
+    ProfileSpan& operator=(const ProfileSpan&) = delete;
+};
+
+#endif
+
@@ -1,8 +1,10 @@
 #include "Section.hpp"
+#include "Listing.hpp"
 #include "Assembler.hpp"
 #include "Context.hpp"
 #include "Error.hpp"
 #include "InstructionStatement.hpp"
+#include <algorithm>
 #include <sstream>
 #include <format>
 
@@ -12,6 +14,11 @@ Section::Section(SectionInfo* sectionInfo)
 : offset{0}, bytes{}, sectionInfo{sectionInfo} {
 }
 
+void Section::reset() {
+    this->offset = 0;
+    this->bytes.clear();
+}
+
 bool Section::assertWritable(
     Context& context,
     const Location& location
@@ -25,6 +32,14 @@ bool Section::assertWritable(
     return true;
 }
 
+bool Section::isWritable() const {
+    return this->sectionInfo->writable;
+}
+
+bool Section::isDiscarded(const Context& context) const {
+    return context.discarding && this->sectionInfo->writable;
+}
+
 bool Section::writeInteger(
     Context& context,
     const Location& location,
@@ -37,6 +52,10 @@ bool Section::writeInteger(
         return false;
     }
 
+    if (this->isDiscarded(context)) {
+        return true;
+    }
+
     *this->offset += number;
 
     if (!value.has_value()) {
@@ -49,16 +68,53 @@ bool Section::writeInteger(
     return true;
 }
 
+std::optional<Size> getRelocationSize(int number, int shift) {
+    if (number == 2 && shift == 0) {
+        return Size::Word;
+    }
+    if (number == 1 && shift == 0) {
+        return Size::Byte;
+    }
+    if (number == 1 && shift == 1) {
+        return Size::Page;
+    }
+    return std::nullopt;
+}
+
 bool Section::writeInteger(
     Context& context,
     const Expression* expr,
     int number,
     int shift
 ) {
+    context.relocationBases.clear();
+    context.inOperand = true;
+    auto value = expr->evaluate(context);
+    context.inOperand = false;
+
+    if (value && this->offset && !this->isDiscarded(context)) {
+        auto relocation = context.getRelocation(expr, *value);
+        if (relocation) {
+            auto size = getRelocationSize(number, shift);
+            if (!size) {
+                context.error(
+                    Error::Level::Fatal,
+                    std::format("{} byte operand cannot be relocated", number),
+                    expr->location
+                );
+            } else {
+                relocation->section = this->sectionInfo->name;
+                relocation->offset = *this->offset;
+                relocation->size = *size;
+                context.relocations.push_back(*relocation);
+            }
+        }
+    }
+
     return this->writeInteger(
         context,
         expr->location,
-        expr->evaluate(context),
+        value,
         number,
         shift
     );
@@ -70,7 +126,7 @@ bool Section::writeBytes(
     const std::vector<char>& bytes
 ) {
     auto isWritable = this->assertWritable(context, location);
-    if (!isWritable || !this->offset) {
+    if (!isWritable || !this->offset || this->isDiscarded(context)) {
         return isWritable;
     }
     *this->offset += bytes.size();
@@ -78,6 +134,74 @@ bool Section::writeBytes(
     return true;
 }
 
+bool Section::writeIntegers(
+    Context& context,
+    const Location& location,
+    const std::vector<std::int64_t>& values,
+    int number,
+    int shift
+) {
+    auto isWritable = this->assertWritable(context, location);
+    if (!isWritable || !this->offset) {
+        return false;
+    }
+
+    if (this->isDiscarded(context)) {
+        return true;
+    }
+
+    *this->offset += values.size() * number;
+
+    this->bytes.reserve(this->bytes.size() + values.size() * number);
+    for (auto value : values) {
+        for (int i = 0; i < number; ++i) {
+            this->bytes.push_back((value >> ((i + shift) * 8)) & 0xff);
+        }
+    }
+    return true;
+}
+
+Section::Mark Section::mark() const {
+    return {this->offset, this->bytes.size()};
+}
+
+bool Section::replicate(const Section::Mark& mark, std::int64_t count) {
+    if (!mark.offset || !this->offset || count < 0) {
+        return false;
+    }
+
+    std::int64_t length = *this->offset - *mark.offset;
+    std::size_t written = this->bytes.size() - mark.size;
+    if (this->sectionInfo->writable
+        ? written != static_cast<std::size_t>(length)
+        : written != 0
+    ) {
+        return false;
+    }
+
+    *this->offset += length * count;
+    if (written == 0) {
+        return true;
+    }
+
+    if (written == 1) {
+        char fill = this->bytes.back();
+        this->bytes.resize(this->bytes.size() + count, fill);
+        return true;
+    }
+
+    std::size_t end = this->bytes.size();
+    this->bytes.resize(end + written * count);
+    for (std::int64_t i = 0; i < count; ++i) {
+        std::copy_n(
+            this->bytes.begin() + mark.size,
+            written,
+            this->bytes.begin() + end + i * written
+        );
+    }
+    return true;
+}
+
 bool Section::writeAddress(
     Context& context,
     Size size,
@@ -133,12 +257,38 @@ bool Section::writeInstruction(
 
     auto opcode = context.assembler->instructionSet.getOpcode(ins);
 
+    Mark start = this->mark();
     bool result = this->writeByte(context, statement->location, *opcode);
 
     const std::vector<SizedAddress>& mode = micros->instruction.mode.mode;
+    std::optional<std::int64_t> target{};
     for (std::size_t i = 0; i < mode.size(); ++i) {
+        std::size_t operand = this->bytes.size();
         result = result
             && this->writeAddress(context, mode[i].size, statement->arguments[i]);
+
+        // Read back from the image, as evaluating again could raise the
+        // same errors twice.
+        if (context.listing
+            && !target
+            && mode[i].address.mode == Mode::Immediate
+            && mode[i].size == Size::Word
+            && this->bytes.size() == operand + 2
+        ) {
+            target = static_cast<std::uint8_t>(this->bytes[operand])
+                | static_cast<std::uint8_t>(this->bytes[operand + 1]) << 8;
+        }
+    }
+
+    if (context.listing) {
+        this->list(
+            context,
+            statement->location,
+            start,
+            getCycles(*micros),
+            false,
+            target
+        );
     }
 
     /*bool firstResult = this->writeAddress(
@@ -156,7 +306,8 @@ bool Section::writeInstruction(
 bool Section::reserve(
     Context& context,
     const Location& location,
-    std::optional<std::int64_t> number
+    std::optional<std::int64_t> number,
+    bool layout
 ) {
     if (!number.has_value()) {
         this->offset = {};
@@ -170,7 +321,7 @@ bool Section::reserve(
         return false;
     }
 
-    if (!this->offset) {
+    if (!this->offset || (!layout && this->isDiscarded(context))) {
         return true;
     }
 
@@ -219,7 +370,8 @@ bool Section::changeAddress(
     return this->reserve(
         context,
         location,
-        address.value() - *this->getAddress()
+        address.value() - *this->getAddress(),
+        true
     );
 }
 
@@ -256,7 +408,7 @@ bool Section::align(
         );
         return false;
     }
-    return this->reserve(context, location, reservation);
+    return this->reserve(context, location, reservation, true);
 }
 
 bool Section::align(Context& context, const Expression* expr) {
@@ -271,6 +423,10 @@ std::optional<std::int64_t> Section::getAddress() {
     return *this->offset + this->sectionInfo->start;
 }
 
+std::optional<std::int64_t> Section::getOffset() const {
+    return this->offset;
+}
+
 
 bool Section::writeByte(
     Context& context,
@@ -300,3 +456,36 @@ std::span<const char> Section::getBytes() const {
     return this->bytes;
 }
 
+std::size_t Section::getCapacity() const {
+    return this->bytes.capacity();
+}
+
+void Section::list(
+    Context& context,
+    const Location& location,
+    const Mark& start,
+    std::optional<int> cycles,
+    bool label,
+    std::optional<std::int64_t> target
+) const {
+    if (this->isDiscarded(context)) {
+        return;
+    }
+
+    std::optional<std::int64_t> address{};
+    if (start.offset) {
+        address = *start.offset + this->sectionInfo->start;
+    }
+
+    context.listingLines.push_back({
+        this->sectionInfo->name,
+        address,
+        start.size,
+        this->bytes.size() - start.size,
+        location,
+        cycles,
+        target,
+        label
+    });
+}
+
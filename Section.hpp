@@ -20,9 +20,18 @@ private:
     SectionInfo* sectionInfo;
 
 public:
+    class Mark {
+    public:
+        std::optional<std::int64_t> offset;
+        std::size_t size;
+    };
+
     Section();
     Section(SectionInfo* sectionInfo);
 
+    // Empties the section, keeping the capacity of its image.
+    void reset();
+
     bool writeInteger(
         Context& context,
         const Location& location,
@@ -44,6 +53,21 @@ public:
         const std::vector<char>& bytes
     );
 
+    bool writeIntegers(
+        Context& context,
+        const Location& location,
+        const std::vector<std::int64_t>& values,
+        int number,
+        int shift = 0
+    );
+
+    Mark mark() const;
+
+    // Appends everything written since `mark` another `count` times.
+    // Returns false and leaves the section untouched if the output since
+    // `mark` is incomplete.
+    bool replicate(const Mark& mark, std::int64_t count);
+
     bool writeByte(
         Context& context,
         const Location& location,
@@ -71,10 +95,13 @@ public:
         const InstructionStatement* instructionStatement
     );
 
+    // Padding for `address` and `align` is `layout`, and is kept even in
+    // removed routines so that what follows lands where it should.
     bool reserve(
         Context& context,
         const Location& location,
-        std::optional<std::int64_t> number
+        std::optional<std::int64_t> number,
+        bool layout = false
     );
 
     bool reserve(Context& context, const Expression* expr);
@@ -97,9 +124,30 @@ public:
 
     std::optional<std::int64_t> getAddress();
 
+    std::optional<std::int64_t> getOffset() const;
+
     bool assertWritable(Context& context, const Location& location) const;
 
+    bool isWritable() const;
+
+    // True if output belongs to a routine being eliminated.
+    bool isDiscarded(const Context& context) const;
+
     std::span<const char> getBytes() const;
+
+    // Bytes the image has room for before it grows.
+    std::size_t getCapacity() const;
+
+    // Listing only. Records what the statement at `location` wrote since
+    // `start`, unless it belongs to a removed routine.
+    void list(
+        Context& context,
+        const Location& location,
+        const Mark& start,
+        std::optional<int> cycles = {},
+        bool label = false,
+        std::optional<std::int64_t> target = {}
+    ) const;
 };
 
 #endif
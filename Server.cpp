@@ -0,0 +1,242 @@
+#include "Server.hpp"
+#include "Command.hpp"
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include <csignal>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <format>
+#include <sstream>
+
+// Requests are the client's working directory followed by its arguments,
+// responses are the exit status, output and error output. Strings are
+// sent as a 32 bit length followed by their bytes.
+
+bool writeAll(int fd, const char* data, std::size_t size) {
+    while (size > 0) {
+        ssize_t written = ::write(fd, data, size);
+        if (written <= 0) {
+            return false;
+        }
+        data += written;
+        size -= written;
+    }
+    return true;
+}
+
+bool readAll(int fd, char* data, std::size_t size) {
+    while (size > 0) {
+        ssize_t count = ::read(fd, data, size);
+        if (count <= 0) {
+            return false;
+        }
+        data += count;
+        size -= count;
+    }
+    return true;
+}
+
+bool writeInteger(int fd, std::uint32_t value) {
+    return writeAll(fd, reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+std::optional<std::uint32_t> readInteger(int fd) {
+    std::uint32_t value;
+    if (!readAll(fd, reinterpret_cast<char*>(&value), sizeof(value))) {
+        return std::nullopt;
+    }
+    return value;
+}
+
+bool writeString(int fd, const std::string& str) {
+    return writeInteger(fd, str.size())
+        && writeAll(fd, str.data(), str.size());
+}
+
+std::optional<std::string> readString(int fd) {
+    auto size = readInteger(fd);
+    if (!size) {
+        return std::nullopt;
+    }
+
+    std::string str(*size, '\0');
+    if (!readAll(fd, str.data(), str.size())) {
+        return std::nullopt;
+    }
+    return str;
+}
+
+sockaddr_un socketAddress(const std::string& socketPath) {
+    sockaddr_un address{};
+    address.sun_family = AF_UNIX;
+    std::strncpy(address.sun_path, socketPath.c_str(), sizeof(address.sun_path) - 1);
+    return address;
+}
+
+
+AssemblerCache::AssemblerCache()
+: instructionSet{}, parseCaches{}, assemblers{} {}
+
+AssemblerCache::~AssemblerCache() {
+    for (auto& assembler : this->assemblers) {
+        delete assembler.second;
+    }
+    for (auto& parseCache : this->parseCaches) {
+        delete parseCache.second;
+    }
+}
+
+Assembler& AssemblerCache::get(
+    SectionMode sectionMode,
+    const std::vector<std::string>& includePath,
+    const std::optional<std::string>& prelude
+) {
+    std::string workingDirectory = std::filesystem::current_path().string();
+
+    ParseKey parseKey{workingDirectory, includePath};
+    if (!this->parseCaches.contains(parseKey)) {
+        this->parseCaches[parseKey] = new ParseCache{includePath};
+    }
+
+    Key key{workingDirectory, sectionMode, includePath, prelude};
+    if (!this->assemblers.contains(key)) {
+        this->assemblers[key] = new Assembler{
+            sectionMode,
+            this->instructionSet,
+            *this->parseCaches[parseKey],
+            prelude
+        };
+    }
+    return *this->assemblers[key];
+}
+
+
+void serveRequest(int fd, AssemblerCache& cache) {
+    auto workingDirectory = readString(fd);
+    auto argc = readInteger(fd);
+    if (!workingDirectory || !argc) {
+        return;
+    }
+
+    std::vector<std::string> arguments{};
+    for (std::uint32_t i = 0; i < *argc; ++i) {
+        auto argument = readString(fd);
+        if (!argument) {
+            return;
+        }
+        arguments.push_back(*argument);
+    }
+
+    std::vector<char*> argv{};
+    for (auto& argument : arguments) {
+        argv.push_back(argument.data());
+    }
+    argv.push_back(nullptr);
+
+    std::stringstream output{};
+    std::stringstream errors{};
+    int status;
+
+    try {
+        std::filesystem::current_path(*workingDirectory);
+        status = runCommand(*argc, argv.data(), output, errors, &cache);
+    } catch (const std::exception& exception) {
+        errors << exception.what() << '\n';
+        status = 1;
+    }
+
+    writeInteger(fd, status)
+        && writeString(fd, output.str())
+        && writeString(fd, errors.str());
+}
+
+int runServer(const std::string& socketPath, std::ostream& errors) {
+    std::signal(SIGPIPE, SIG_IGN);
+
+    int server = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    if (server < 0) {
+        errors << std::format("failed to create socket: {}\n", std::strerror(errno));
+        return 1;
+    }
+
+    sockaddr_un address = socketAddress(socketPath);
+    ::unlink(socketPath.c_str());
+    if (::bind(server, reinterpret_cast<sockaddr*>(&address), sizeof(address)) < 0
+        || ::listen(server, 16) < 0
+    ) {
+        errors << std::format(
+            "failed to listen on '{}': {}\n",
+            socketPath,
+            std::strerror(errno)
+        );
+        ::close(server);
+        return 1;
+    }
+
+    AssemblerCache cache{};
+
+    for (;;) {
+        int client = ::accept(server, nullptr, nullptr);
+        if (client < 0) {
+            continue;
+        }
+        serveRequest(client, cache);
+        ::close(client);
+    }
+}
+
+std::optional<int> runClient(
+    const std::string& socketPath,
+    int argc,
+    char** argv,
+    std::ostream& output,
+    std::ostream& errors
+) {
+    int fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0) {
+        return std::nullopt;
+    }
+
+    sockaddr_un address = socketAddress(socketPath);
+    if (::connect(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) < 0) {
+        ::close(fd);
+        return std::nullopt;
+    }
+
+    // The server does not see our environment, so pass it as options
+    // ahead of the explicit ones.
+    std::vector<std::string> arguments{argv[0]};
+    if (const char* prelude = std::getenv("ASPDR_PRELUDE")) {
+        arguments.insert(arguments.end(), {"--prelude", prelude});
+    }
+    if (const char* include = std::getenv("ASPDR_INCLUDE")) {
+        arguments.insert(arguments.end(), {"--include", include});
+    }
+    if (const char* cacheDir = std::getenv("ASPDR_CACHE_DIR")) {
+        arguments.insert(arguments.end(), {"--cache-dir", cacheDir});
+    }
+    arguments.insert(arguments.end(), argv + 1, argv + argc);
+
+    bool sent = writeString(fd, std::filesystem::current_path().string())
+        && writeInteger(fd, arguments.size());
+    for (const auto& argument : arguments) {
+        sent = sent && writeString(fd, argument);
+    }
+
+    auto status = sent ? readInteger(fd) : std::nullopt;
+    auto out = status ? readString(fd) : std::nullopt;
+    auto err = out ? readString(fd) : std::nullopt;
+    ::close(fd);
+
+    if (!err) {
+        return std::nullopt;
+    }
+
+    output.write(out->data(), out->size());
+    errors << *err;
+    return *status;
+}
+
@@ -0,0 +1,59 @@
+#ifndef SERVER_HPP
+#define SERVER_HPP
+
+#include "Assembler.hpp"
+#include <map>
+#include <string>
+#include <vector>
+#include <tuple>
+#include <utility>
+#include <optional>
+#include <iostream>
+
+// Assemblers kept alive between requests, one per configuration, sharing
+// one instruction set and a parse cache per include path. File names are
+// relative to the working directory of the request, so it is part of
+// every key.
+class AssemblerCache {
+private:
+    using ParseKey = std::pair<std::string, std::vector<std::string>>;
+    using Key = std::tuple<
+        std::string,
+        SectionMode,
+        std::vector<std::string>,
+        std::optional<std::string>
+    >;
+
+    const InstructionSet instructionSet;
+    std::map<ParseKey, ParseCache*> parseCaches;
+    std::map<Key, Assembler*> assemblers;
+
+public:
+    AssemblerCache();
+    ~AssemblerCache();
+
+    AssemblerCache(const AssemblerCache&) = delete;
+    AssemblerCache& operator=(const AssemblerCache&) = delete;
+
+    Assembler& get(
+        SectionMode sectionMode,
+        const std::vector<std::string>& includePath,
+        const std::optional<std::string>& prelude
+    );
+};
+
+// Serves assemble requests on a unix socket until killed.
+int runServer(const std::string& socketPath, std::ostream& errors);
+
+// Forwards a command to the server at `socketPath`. Returns the exit status
+// of the command, or nothing if the server could not be reached.
+std::optional<int> runClient(
+    const std::string& socketPath,
+    int argc,
+    char** argv,
+    std::ostream& output,
+    std::ostream& errors
+);
+
+#endif
+
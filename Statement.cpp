@@ -3,14 +3,27 @@
 #include "Error.hpp"
 #include "Context.hpp"
 #include "Block.hpp"
+#include <format>
 
-int Statement::statementIdCounter = 0;
+std::atomic<int> Statement::statementIdCounter = 0;
 
 Statement::Statement() : Statement{Location{}} {}
 
 Statement::Statement(Location location)
 : location{location}, statementId{Statement::statementIdCounter++} {}
 
+int Statement::getNextId() {
+    return Statement::statementIdCounter;
+}
+
+void Statement::setNextId(int id) {
+    Statement::statementIdCounter = id;
+}
+
+bool Statement::isIterationInvariant(const Context& context) const {
+    return false;
+}
+
 Statement::~Statement() {}
 
 
@@ -24,11 +37,11 @@ bool assembleLabel(
 ) {
     auto address = context.getSection().getAddress();
     if (!address) {
-        context.error(
+        context.error({
             Error::Level::Pass,
-            "cannot get address",
+            Error::Code::UnknownAddress,
             location
-        );
+        });
         return false;
     }
 
@@ -39,6 +52,35 @@ bool assembleLabel(
     }
 
     context.setScope(qualifiedId.value());
+    context.labels.insert(qualifiedId.value());
+
+    if (context.assembler->isEliminatingRoutines()
+        && qualifiedId->value.size() == 1
+        && context.getSection().isWritable()
+    ) {
+        const std::string& name = qualifiedId->value[0];
+        context.currentRoutine = name;
+        context.discarding = context.assembler->isRoutineRemoved(name);
+        context.routineStarts.push_back({name, *context.getSection().getOffset()});
+        if (context.fixingRoutine) {
+            context.fixedRoutines.insert(name);
+            context.fixingRoutine = false;
+        }
+    }
+
+    // Listed after the routine it starts, so that labels of removed
+    // routines are left out.
+    if (context.listing) {
+        auto& section = context.getSection();
+        section.list(context, location, section.mark(), {}, true);
+    }
+
+    if (context.assembler->isRelocatable()) {
+        context.assembler->setSymbolBase(
+            *qualifiedId,
+            RelocationBase{context.currentSection, false}
+        );
+    }
 
     return context.assembler->assignSymbol(
         context,
@@ -52,6 +94,10 @@ bool LabelStatement::assemble(Context& context) {
     return assembleLabel(context, this->location, this->id);
 }
 
+void LabelStatement::addMemoryUsage(MemoryTallies& usage) const {
+    usage["LabelStatement"].add(sizeof(*this) + getHeapSize(this->id.identifier));
+}
+
 
 SymbolStatement::SymbolStatement(
     Location location,
@@ -60,18 +106,30 @@ SymbolStatement::SymbolStatement(
 ) : Statement{location}, id{id}, expr{expr} {}
 
 bool SymbolStatement::assemble(Context& context) {
+    context.relocationBases.clear();
     std::optional<std::int64_t> result = this->expr->evaluate(context);
     if (!result.has_value()) {
         return false;
     }
 
+    auto relocation = context.getRelocation(this->expr, *result);
     auto qualifiedId = context.qualify(this->location, this->id);
 
+    // Symbols computed from labels move with them when linked.
+    if (relocation && qualifiedId) {
+        context.assembler->setSymbolBase(*qualifiedId, relocation->base);
+    }
+
     return context.assembler->assignSymbol(
         context, this->location, qualifiedId, result.value()
     );
 }
 
+void SymbolStatement::addMemoryUsage(MemoryTallies& usage) const {
+    usage["SymbolStatement"].add(sizeof(*this) + getHeapSize(this->id.identifier));
+    this->expr->addMemoryUsage(usage);
+}
+
 SymbolStatement::~SymbolStatement() {
     delete expr;
 }
@@ -84,14 +142,65 @@ bool SectionStatement::assemble(Context& context) {
     return context.changeSection(this->location, this->sectionId);
 }
 
+void SectionStatement::addMemoryUsage(MemoryTallies& usage) const {
+    usage["SectionStatement"].add(sizeof(*this) + getHeapSize(this->sectionId));
+}
+
 
 AddressStatement::AddressStatement(Location location, Expression* expr)
     : Statement{location}, expr{expr} {}
 
+// Modules are placed by the linker, so fixed layout cannot be assembled
+// into them.
+bool rejectRelocatable(
+    Context& context,
+    const Location& location,
+    const char* directive
+) {
+    if (!context.assembler->isRelocatable()) {
+        return false;
+    }
+
+    context.error(
+        Error::Level::Fatal,
+        std::format("'{}' cannot be used in a relocatable module", directive),
+        location
+    );
+    return true;
+}
+
+// Routine elimination only. Padding after this point is not part of the
+// routine before it.
+void markLayout(Context& context) {
+    auto offset = context.getSection().getOffset();
+    if (offset) {
+        context.layoutOffsets.push_back(*offset);
+    }
+}
+
 bool AddressStatement::assemble(Context& context) {
+    if (rejectRelocatable(context, this->location, "address")) {
+        return false;
+    }
+
+    // Code placed at a fixed address, such as a vector, is always kept.
+    // It belongs to the routine whose label follows, and any code before
+    // that label is emitted even if the routine around it was removed.
+    if (context.assembler->isEliminatingRoutines()
+        && context.getSection().isWritable()
+    ) {
+        markLayout(context);
+        context.fixingRoutine = true;
+        context.discarding = false;
+    }
     return context.getSection().changeAddress(context, this->expr);
 }
 
+void AddressStatement::addMemoryUsage(MemoryTallies& usage) const {
+    usage["AddressStatement"].add(sizeof(*this));
+    this->expr->addMemoryUsage(usage);
+}
+
 AddressStatement::~AddressStatement() {
     delete expr;
 }
@@ -101,9 +210,24 @@ AlignStatement::AlignStatement(Location location, Expression* expr)
     : Statement{location}, expr{expr} {}
 
 bool AlignStatement::assemble(Context& context) {
+    if (rejectRelocatable(context, this->location, "align")) {
+        return false;
+    }
+
+    if (context.assembler->isEliminatingRoutines()
+        && context.getSection().isWritable()
+    ) {
+        markLayout(context);
+    }
+
     return context.getSection().align(context, this->expr);
 }
 
+void AlignStatement::addMemoryUsage(MemoryTallies& usage) const {
+    usage["AlignStatement"].add(sizeof(*this));
+    this->expr->addMemoryUsage(usage);
+}
+
 AlignStatement::~AlignStatement() {
     delete expr;
 }
@@ -116,6 +240,15 @@ bool ReserveStatement::assemble(Context& context) {
     return context.getSection().reserve(context, this->expr);
 }
 
+void ReserveStatement::addMemoryUsage(MemoryTallies& usage) const {
+    usage["ReserveStatement"].add(sizeof(*this));
+    this->expr->addMemoryUsage(usage);
+}
+
+bool ReserveStatement::isIterationInvariant(const Context& context) const {
+    return this->expr->isIterationInvariant();
+}
+
 ReserveStatement::~ReserveStatement() {
     delete expr;
 }
@@ -125,12 +258,36 @@ DataStatement::DataStatement(
     Location location,
     std::vector<DataElement*> elements,
     int defaultSize
-) : Statement{location}, elements{elements}, defaultSize{defaultSize} {}
+)
+:   Statement{location},
+    elements{packElements(elements, defaultSize)},
+    defaultSize{defaultSize} {}
 
 bool DataStatement::assemble(Context& context) {
+    Section::Mark start = context.getSection().mark();
     for (auto& elem : this->elements) {
         elem->write(context, this->defaultSize);
     }
+
+    if (context.listing) {
+        context.getSection().list(context, this->location, start);
+    }
+    return true;
+}
+
+void DataStatement::addMemoryUsage(MemoryTallies& usage) const {
+    usage["DataStatement"].add(sizeof(*this) + getHeapSize(this->elements));
+    for (const auto* element : this->elements) {
+        element->addMemoryUsage(usage);
+    }
+}
+
+bool DataStatement::isIterationInvariant(const Context& context) const {
+    for (auto& elem : this->elements) {
+        if (!elem->isIterationInvariant()) {
+            return false;
+        }
+    }
     return true;
 }
 
@@ -149,6 +306,7 @@ IncludeStatement::IncludeStatement(
 
 bool IncludeStatement::assemble(Context& context) {
     if (type == IncludeStatement::Type::Assembly) {
+        ProfileSpan span{context.profiler, "include", this->fileName};
         return context.assembler->assemble(
             context,
             this->fileName,
@@ -172,6 +330,10 @@ bool IncludeStatement::assemble(Context& context) {
     ASSEMBLER_ERROR("Not implemented");
 }
 
+void IncludeStatement::addMemoryUsage(MemoryTallies& usage) const {
+    usage["IncludeStatement"].add(sizeof(*this) + getHeapSize(this->fileName));
+}
+
 
 VariableStatement::VariableStatement(
     Location location,
@@ -191,6 +353,11 @@ bool VariableStatement::assemble(Context& context) {
     return context.changeSection(this->location, s);
 }
 
+void VariableStatement::addMemoryUsage(MemoryTallies& usage) const {
+    usage["VariableStatement"].add(sizeof(*this) + getHeapSize(this->id.identifier));
+    this->expr->addMemoryUsage(usage);
+}
+
 
 ProvidesStatement::ProvidesStatement(Location location, std::string fileName)
 : Statement{location}, fileName{fileName} {
@@ -200,6 +367,10 @@ bool ProvidesStatement::assemble(Context& context) {
     return !context.markAsIncluded(this->fileName);
 }
 
+void ProvidesStatement::addMemoryUsage(MemoryTallies& usage) const {
+    usage["ProvidesStatement"].add(sizeof(*this) + getHeapSize(this->fileName));
+}
+
 ConditionalStatement::ConditionalStatement(
     Location location,
     Expression* condition,
@@ -222,6 +393,30 @@ bool ConditionalStatement::assemble(Context& context) {
     return true;
 }
 
+void ConditionalStatement::addMemoryUsage(MemoryTallies& usage) const {
+    usage["ConditionalStatement"].add(sizeof(*this));
+    this->condition->addMemoryUsage(usage);
+    this->body->addMemoryUsage(usage);
+    if (this->elseBody) {
+        this->elseBody.value()->addMemoryUsage(usage);
+    }
+}
+
+bool ConditionalStatement::isIterationInvariant(const Context& context) const {
+    return this->condition->isIterationInvariant()
+        && this->body->isIterationInvariant(context)
+        && (!this->elseBody
+            || this->elseBody.value()->isIterationInvariant(context));
+}
+
+ConditionalStatement::~ConditionalStatement() {
+    delete this->condition;
+    delete this->body;
+    if (this->elseBody) {
+        delete *this->elseBody;
+    }
+}
+
 RepeatStatement::RepeatStatement(
     Location location,
     Expression* times,
@@ -235,9 +430,38 @@ bool RepeatStatement::assemble(Context& context) {
         return false;
     }
 
+    ProfileSpan span{
+        context.profiler,
+        "repeat",
+        this->location.begin.filename
+            ? std::string_view{*this->location.begin.filename}
+            : std::string_view{},
+        this->location.begin.line
+    };
+
     context.frames.push(Frame{Frame::Type::Loop, this->statementId});
 
+    // An iteration-invariant body is assembled once and its output copied
+    // for the remaining iterations, unless each is to be listed.
+    bool invariant = value.value() > 1
+        && !context.listing
+        && this->body->isIterationInvariant(context);
+    std::string section = context.currentSection;
+    Section::Mark mark = context.getSection().mark();
+    std::size_t errorCount = context.getErrors().size();
+    std::size_t relocationCount = context.relocations.size();
+
     for (int i = 0; i < value.value(); ++i) {
+        if (i == 1
+            && invariant
+            && context.currentSection == section
+            && context.getErrors().size() == errorCount
+            && context.relocations.size() == relocationCount
+            && context.getSection().replicate(mark, value.value() - 1)
+        ) {
+            break;
+        }
+
         context.frames.push(Frame{Frame::Type::Index, i});
 
         if (this->counter) {
@@ -256,3 +480,177 @@ bool RepeatStatement::assemble(Context& context) {
 
     return true;
 }
+
+void RepeatStatement::addMemoryUsage(MemoryTallies& usage) const {
+    usage["RepeatStatement"].add(
+        sizeof(*this) + (this->counter ? getHeapSize(*this->counter) : 0)
+    );
+    this->times->addMemoryUsage(usage);
+    this->body->addMemoryUsage(usage);
+}
+
+bool RepeatStatement::isIterationInvariant(const Context& context) const {
+    return !this->counter
+        && this->times->isIterationInvariant()
+        && this->body->isIterationInvariant(context);
+}
+
+RepeatStatement::~RepeatStatement() {
+    delete this->times;
+    delete this->body;
+}
+
+
+TableStatement::TableStatement(
+    Location location,
+    TableStatement::Type type,
+    std::string index,
+    Expression* start,
+    Expression* end,
+    Expression* value
+)
+:   Statement{location},
+    type{type},
+    index{index},
+    start{start},
+    end{end},
+    value{value} {}
+
+bool TableStatement::assemble(Context& context) {
+    auto start = this->start->mustEvaluate(context);
+    auto end = this->end->mustEvaluate(context);
+    if (!start.has_value() || !end.has_value()) {
+        return false;
+    }
+
+    // No table can be larger than the address space. Taken as unsigned,
+    // since the difference may not fit a signed integer.
+    const std::uint64_t maxEntries = 0x10000;
+    std::uint64_t entries = static_cast<std::uint64_t>(*end)
+        - static_cast<std::uint64_t>(*start);
+    if (*end > *start && entries > maxEntries) {
+        context.error(
+            Error::Level::Fatal,
+            std::format(
+                "table has {} entries, more than the {} that fit in memory",
+                entries,
+                maxEntries
+            ),
+            this->location
+        );
+        return false;
+    }
+
+    std::vector<std::int64_t> indices{};
+    if (*end > *start) {
+        indices.resize(*end - *start);
+        for (std::size_t i = 0; i < indices.size(); ++i) {
+            indices[i] = *start + i;
+        }
+    }
+
+    TableIndex tableIndex{this->index, std::move(indices)};
+    std::vector<std::int64_t> values{};
+    context.relocationBases.clear();
+    bool evaluated = this->value->evaluateTable(context, tableIndex, values);
+
+    if (evaluated && !context.relocationBases.empty()) {
+        context.error(
+            Error::Level::Fatal,
+            "table values cannot depend on relocatable symbols",
+            this->location
+        );
+        evaluated = false;
+    }
+
+    auto& section = context.getSection();
+    Section::Mark mark = section.mark();
+    const int size = this->type == TableStatement::Type::Word ? 2 : 1;
+    const int count = this->type == TableStatement::Type::Split ? 2 : 1;
+
+    bool result = true;
+    if (!evaluated) {
+        result = section.writeInteger(
+            context,
+            this->location,
+            std::nullopt,
+            tableIndex.values.size() * size * count
+        );
+    } else {
+        for (int shift = 0; shift < count; ++shift) {
+            result = section.writeIntegers(
+                context,
+                this->location,
+                values,
+                size,
+                shift
+            ) && result;
+        }
+    }
+
+    if (context.listing) {
+        section.list(context, this->location, mark);
+    }
+    return result;
+}
+
+void TableStatement::addMemoryUsage(MemoryTallies& usage) const {
+    usage["TableStatement"].add(sizeof(*this) + getHeapSize(this->index));
+    this->start->addMemoryUsage(usage);
+    this->end->addMemoryUsage(usage);
+    this->value->addMemoryUsage(usage);
+}
+
+bool TableStatement::isIterationInvariant(const Context& context) const {
+    return this->start->isIterationInvariant()
+        && this->end->isIterationInvariant()
+        && this->value->isIterationInvariant();
+}
+
+TableStatement::~TableStatement() {
+    delete this->start;
+    delete this->end;
+    delete this->value;
+}
+
+
+CycleBudgetStatement::CycleBudgetStatement(
+    Location location,
+    Expression* start,
+    Expression* end,
+    Expression* max
+) : Statement{location}, start{start}, end{end}, max{max} {}
+
+bool CycleBudgetStatement::assemble(Context& context) {
+    auto start = this->start->evaluate(context);
+    auto end = this->end->evaluate(context);
+    auto max = this->max->evaluate(context);
+    if (!start || !end || !max) {
+        return false;
+    }
+
+    if (*end < *start) {
+        context.error(
+            Error::Level::Fatal,
+            "cycle budget region ends before it starts",
+            this->location
+        );
+        return false;
+    }
+
+    context.cycleBudgets.push_back({this->location, *start, *end, *max});
+    return true;
+}
+
+void CycleBudgetStatement::addMemoryUsage(MemoryTallies& usage) const {
+    usage["CycleBudgetStatement"].add(sizeof(*this));
+    this->start->addMemoryUsage(usage);
+    this->end->addMemoryUsage(usage);
+    this->max->addMemoryUsage(usage);
+}
+
+CycleBudgetStatement::~CycleBudgetStatement() {
+    delete this->start;
+    delete this->end;
+    delete this->max;
+}
@@ -5,8 +5,10 @@
 #include "Identifier.hpp"
 #include "Location.hpp"
 #include "DataElement.hpp"
+#include "MemoryReport.hpp"
 #include <SpdrFirmware/Instruction.hpp>
 #include <SpdrFirmware/Mode.hpp>
+#include <atomic>
 #include <string>
 
 class Context;
@@ -14,15 +16,29 @@ class Block;
 
 class Statement {
 private:
-    static int statementIdCounter;
+    // Atomic since files may be loaded on several threads at once.
+    static std::atomic<int> statementIdCounter;
 public:
     const Location location;
     const int statementId;
 
     Statement();
     Statement(Location location);
+
+    // The id the next statement created gets. Local symbol names are made
+    // from statement ids, so parsing a file again must repeat its ids.
+    static int getNextId();
+    static void setNextId(int id);
+
     virtual bool assemble(Context& context) = 0;
 
+    // True if assembling the statement produces the same bytes in every
+    // iteration of an enclosing repeat block and defines no symbols.
+    virtual bool isIterationInvariant(const Context& context) const;
+
+    // Adds the statement and everything it owns to `usage`, by class.
+    virtual void addMemoryUsage(MemoryTallies& usage) const = 0;
+
     virtual ~Statement();
 };
 
@@ -35,6 +51,7 @@ public:
     LabelStatement(Location location, UnqualifiedIdentifier id);
 
     virtual bool assemble(Context& context) override;
+    virtual void addMemoryUsage(MemoryTallies& usage) const override;
 };
 
 class SymbolStatement : public Statement {
@@ -46,6 +63,7 @@ public:
     SymbolStatement(Location location, UnqualifiedIdentifier id, Expression* expr);
 
     virtual bool assemble(Context& context) override;
+    virtual void addMemoryUsage(MemoryTallies& usage) const override;
 
     virtual ~SymbolStatement() override;
 };
@@ -58,6 +76,7 @@ public:
     //SectionStatement();
     SectionStatement(Location location, std::string sectionId);
     virtual bool assemble(Context& context) override;
+    virtual void addMemoryUsage(MemoryTallies& usage) const override;
 };
 
 class AddressStatement : public Statement {
@@ -67,6 +86,7 @@ public:
     //AddressStatement();
     AddressStatement(Location location, Expression* expr);
     virtual bool assemble(Context& context) override;
+    virtual void addMemoryUsage(MemoryTallies& usage) const override;
 
     virtual ~AddressStatement() override;
 };
@@ -78,6 +98,7 @@ public:
     //AlignStatement();
     AlignStatement(Location location, Expression* expr);
     virtual bool assemble(Context& context) override;
+    virtual void addMemoryUsage(MemoryTallies& usage) const override;
 
     virtual ~AlignStatement() override;
 };
@@ -89,6 +110,8 @@ public:
     //ReserveStatement();
     ReserveStatement(Location location, Expression* expr);
     virtual bool assemble(Context& context) override;
+    virtual void addMemoryUsage(MemoryTallies& usage) const override;
+    virtual bool isIterationInvariant(const Context& context) const override;
 
     virtual ~ReserveStatement() override;
 };
@@ -102,6 +125,8 @@ public:
     DataStatement(Location location, std::vector<DataElement*> elements, int defaultSize = 1);
 
     virtual bool assemble(Context& context) override;
+    virtual void addMemoryUsage(MemoryTallies& usage) const override;
+    virtual bool isIterationInvariant(const Context& context) const override;
 
     virtual ~DataStatement() override;
 };
@@ -119,6 +144,7 @@ public:
     //IncludeStatement();
     IncludeStatement(Location location, IncludeStatement::Type type, std::string fileName);
     virtual bool assemble(Context& context) override;
+    virtual void addMemoryUsage(MemoryTallies& usage) const override;
 };
 
 class VariableStatement : public Statement {
@@ -130,6 +156,7 @@ public:
     virtual ~VariableStatement() override;
 
     virtual bool assemble(Context& context) override;
+    virtual void addMemoryUsage(MemoryTallies& usage) const override;
 };
 
 
@@ -139,6 +166,7 @@ public:
 
     ProvidesStatement(Location location, std::string fileName);
     virtual bool assemble(Context& context) override;
+    virtual void addMemoryUsage(MemoryTallies& usage) const override;
 };
 
 class ConditionalStatement : public Statement {
@@ -155,6 +183,10 @@ public:
     );
 
     virtual bool assemble(Context& context) override;
+    virtual void addMemoryUsage(MemoryTallies& usage) const override;
+    virtual bool isIterationInvariant(const Context& context) const override;
+
+    virtual ~ConditionalStatement() override;
 };
 
 class RepeatStatement : public Statement {
@@ -171,6 +203,61 @@ public:
     );
 
     virtual bool assemble(Context& context) override;
+    virtual void addMemoryUsage(MemoryTallies& usage) const override;
+    virtual bool isIterationInvariant(const Context& context) const override;
+
+    virtual ~RepeatStatement() override;
+};
+
+class TableStatement : public Statement {
+public:
+    enum class Type {
+        Byte,
+        Word,
+        Split,
+    };
+
+    TableStatement::Type type;
+    std::string index;
+    Expression* start;
+    Expression* end;
+    Expression* value;
+
+    TableStatement(
+        Location location,
+        TableStatement::Type type,
+        std::string index,
+        Expression* start,
+        Expression* end,
+        Expression* value
+    );
+
+    virtual bool assemble(Context& context) override;
+    virtual void addMemoryUsage(MemoryTallies& usage) const override;
+    virtual bool isIterationInvariant(const Context& context) const override;
+
+    virtual ~TableStatement() override;
+};
+
+// Asserts that the instructions from `start` up to `end` take at most `max`
+// cycles, checked once the build has settled.
+class CycleBudgetStatement : public Statement {
+public:
+    Expression* start;
+    Expression* end;
+    Expression* max;
+
+    CycleBudgetStatement(
+        Location location,
+        Expression* start,
+        Expression* end,
+        Expression* max
+    );
+
+    virtual bool assemble(Context& context) override;
+    virtual void addMemoryUsage(MemoryTallies& usage) const override;
+
+    virtual ~CycleBudgetStatement() override;
 };
 
 template<typename T>
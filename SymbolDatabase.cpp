@@ -0,0 +1,195 @@
+#include "SymbolDatabase.hpp"
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <format>
+#include <functional>
+#include <sstream>
+#include <string_view>
+#include <vector>
+
+const std::string_view databaseMagic{"ASPDRSYM"};
+const std::uint32_t databaseVersion = 1;
+
+const std::size_t headerSize = 16;
+const std::size_t entrySize = 16;
+
+std::uint64_t readLittleEndian(const char* data, int bytes) {
+    std::uint64_t value = 0;
+    for (int i = bytes - 1; i >= 0; --i) {
+        value = (value << 8) | static_cast<std::uint8_t>(data[i]);
+    }
+    return value;
+}
+
+void writeLittleEndian(std::ostream& stream, std::uint64_t value, int bytes) {
+    for (int i = 0; i < bytes; ++i) {
+        stream.put(static_cast<char>(value & 0xff));
+        value >>= 8;
+    }
+}
+
+std::string getSymbolName(const Identifier& identifier) {
+    std::stringstream ss{};
+    ss << identifier;
+    return ss.str();
+}
+
+
+SymbolDatabase::SymbolDatabase(
+    std::string path,
+    const char* data,
+    std::size_t size,
+    std::uint32_t count
+) : path{path}, data{data}, size{size}, count{count} {}
+
+SymbolDatabase::SymbolDatabase(SymbolDatabase&& other)
+:   path{std::move(other.path)},
+    data{other.data},
+    size{other.size},
+    count{other.count}
+{
+    other.data = nullptr;
+    other.size = 0;
+    other.count = 0;
+}
+
+SymbolDatabase::~SymbolDatabase() {
+    if (this->data) {
+        ::munmap(const_cast<char*>(this->data), this->size);
+    }
+}
+
+std::optional<SymbolDatabase> SymbolDatabase::open(
+    const std::string& path,
+    std::string& error
+) {
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        error = std::format("failed to open '{}': {}", path, std::strerror(errno));
+        return std::nullopt;
+    }
+
+    struct stat status{};
+    if (::fstat(fd, &status) < 0) {
+        error = std::format("failed to read '{}': {}", path, std::strerror(errno));
+        ::close(fd);
+        return std::nullopt;
+    }
+
+    std::size_t size = status.st_size;
+    if (size < headerSize) {
+        error = std::format("'{}' is not a symbol database", path);
+        ::close(fd);
+        return std::nullopt;
+    }
+
+    void* mapping = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (mapping == MAP_FAILED) {
+        error = std::format("failed to map '{}': {}", path, std::strerror(errno));
+        return std::nullopt;
+    }
+
+    const char* data = static_cast<const char*>(mapping);
+    std::uint32_t version = readLittleEndian(data + databaseMagic.size(), 4);
+    std::uint32_t count = readLittleEndian(data + databaseMagic.size() + 4, 4);
+
+    if (std::string_view{data, databaseMagic.size()} != databaseMagic
+        || version != databaseVersion
+        || (size - headerSize) / entrySize < count
+    ) {
+        error = std::format("'{}' is not a symbol database", path);
+        ::munmap(mapping, size);
+        return std::nullopt;
+    }
+
+    return SymbolDatabase{path, data, size, count};
+}
+
+void SymbolDatabase::write(
+    const std::map<Identifier, std::int64_t>& symbols,
+    std::ostream& stream
+) {
+    // Identifiers order by component, names by byte, so sort again.
+    std::vector<std::pair<std::string, std::int64_t>> entries{};
+    for (const auto& symbol : symbols) {
+        entries.push_back({getSymbolName(symbol.first), symbol.second});
+    }
+    std::sort(entries.begin(), entries.end());
+
+    stream.write(databaseMagic.data(), databaseMagic.size());
+    writeLittleEndian(stream, databaseVersion, 4);
+    writeLittleEndian(stream, entries.size(), 4);
+
+    std::uint64_t offset = 0;
+    for (const auto& entry : entries) {
+        writeLittleEndian(stream, offset, 4);
+        writeLittleEndian(stream, entry.first.size(), 4);
+        writeLittleEndian(stream, entry.second, 8);
+        offset += entry.first.size();
+    }
+
+    for (const auto& entry : entries) {
+        stream.write(entry.first.data(), entry.first.size());
+    }
+}
+
+const std::string& SymbolDatabase::getPath() const {
+    return this->path;
+}
+
+std::size_t SymbolDatabase::getHash() const {
+    return std::hash<std::string_view>{}(std::string_view{this->data, this->size});
+}
+
+std::size_t SymbolDatabase::getCount() const {
+    return this->count;
+}
+
+std::string_view SymbolDatabase::getName(std::uint32_t index) const {
+    const char* entry = this->data + headerSize + index * entrySize;
+    std::size_t namesStart = headerSize + this->count * entrySize;
+    std::size_t offset = readLittleEndian(entry, 4);
+    std::size_t length = readLittleEndian(entry + 4, 4);
+
+    // A damaged name reads as empty rather than past the mapping.
+    if (offset > this->size - namesStart
+        || length > this->size - namesStart - offset
+    ) {
+        return {};
+    }
+    return {this->data + namesStart + offset, length};
+}
+
+std::int64_t SymbolDatabase::getValue(std::uint32_t index) const {
+    const char* entry = this->data + headerSize + index * entrySize;
+    return static_cast<std::int64_t>(readLittleEndian(entry + 8, 8));
+}
+
+std::optional<std::int64_t> SymbolDatabase::lookup(
+    const Identifier& identifier
+) const {
+    std::string name = getSymbolName(identifier);
+
+    std::uint32_t low = 0;
+    std::uint32_t high = this->count;
+    while (low < high) {
+        std::uint32_t middle = low + (high - low) / 2;
+        if (this->getName(middle) < name) {
+            low = middle + 1;
+        } else {
+            high = middle;
+        }
+    }
+
+    if (low < this->count && this->getName(low) == name) {
+        return this->getValue(low);
+    }
+    return std::nullopt;
+}
+
@@ -0,0 +1,71 @@
+#ifndef SYMBOLDATABASE_HPP
+#define SYMBOLDATABASE_HPP
+
+#include "Identifier.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <map>
+#include <optional>
+#include <string>
+#include <string_view>
+
+// The final symbols of one program, such as a ROM monitor, for other
+// programs to use without assembling it again. Databases are mapped rather
+// than read and looked up by binary search, so opening one costs the same
+// however many symbols it has.
+//
+// All integers are little endian. A database is a header of the eight
+// bytes "ASPDRSYM", a 32 bit version (1) and a 32 bit symbol count, then
+// one entry per symbol sorted by name, then the names. An entry is the 32
+// bit offset of its name from the start of the names, the 32 bit length of
+// the name and the 64 bit value. Names are written joined with '.'.
+class SymbolDatabase {
+private:
+    std::string path;
+    const char* data;
+    std::size_t size;
+    std::uint32_t count;
+
+    SymbolDatabase(
+        std::string path,
+        const char* data,
+        std::size_t size,
+        std::uint32_t count
+    );
+
+    std::string_view getName(std::uint32_t index) const;
+    std::int64_t getValue(std::uint32_t index) const;
+
+public:
+    SymbolDatabase(SymbolDatabase&& other);
+    ~SymbolDatabase();
+
+    SymbolDatabase(const SymbolDatabase&) = delete;
+    SymbolDatabase& operator=(const SymbolDatabase&) = delete;
+    SymbolDatabase& operator=(SymbolDatabase&&) = delete;
+
+    // Maps the database at `path`. Returns nothing and sets `error` if it
+    // cannot be read or is not a symbol database.
+    static std::optional<SymbolDatabase> open(
+        const std::string& path,
+        std::string& error
+    );
+
+    static void write(
+        const std::map<Identifier, std::int64_t>& symbols,
+        std::ostream& stream
+    );
+
+    const std::string& getPath() const;
+
+    // Hash of the contents as mapped, comparable with hashFile.
+    std::size_t getHash() const;
+
+    std::size_t getCount() const;
+
+    std::optional<std::int64_t> lookup(const Identifier& identifier) const;
+};
+
+#endif
+
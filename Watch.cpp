@@ -0,0 +1,114 @@
+#include "Watch.hpp"
+#include <sys/inotify.h>
+#include <poll.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstring>
+#include <filesystem>
+#include <format>
+#include <map>
+#include <set>
+
+// Directories are watched rather than files so that editors replacing a
+// file by renaming over it are noticed.
+const std::uint32_t watchMask =
+    IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE | IN_DELETE;
+
+// Time to wait for further events after a change before rebuilding.
+const int settleMilliseconds = 50;
+
+class Watcher {
+private:
+    int fd;
+    std::map<int, std::filesystem::path> directories;
+    std::set<std::filesystem::path> files;
+
+public:
+    Watcher(int fd);
+
+    void update(const std::vector<std::string>& paths);
+
+    // Reads pending events, returning whether any concerned a watched file.
+    bool readEvents();
+
+    bool wait(int timeout);
+};
+
+Watcher::Watcher(int fd) : fd{fd}, directories{}, files{} {}
+
+void Watcher::update(const std::vector<std::string>& paths) {
+    this->files.clear();
+
+    for (const auto& path : paths) {
+        auto file = std::filesystem::absolute(path).lexically_normal();
+        this->files.insert(file);
+
+        int wd = inotify_add_watch(
+            this->fd,
+            file.parent_path().c_str(),
+            watchMask
+        );
+        if (wd >= 0) {
+            this->directories[wd] = file.parent_path();
+        }
+    }
+}
+
+bool Watcher::readEvents() {
+    alignas(inotify_event) char buffer[4096];
+    bool changed = false;
+
+    ssize_t length = ::read(this->fd, buffer, sizeof(buffer));
+    for (ssize_t i = 0; i < length;) {
+        auto event = reinterpret_cast<inotify_event*>(&buffer[i]);
+        i += sizeof(inotify_event) + event->len;
+
+        if (event->len == 0 || !this->directories.contains(event->wd)) {
+            continue;
+        }
+
+        auto file = this->directories[event->wd] / event->name;
+        changed = changed || this->files.contains(file);
+    }
+    return changed;
+}
+
+bool Watcher::wait(int timeout) {
+    pollfd pfd{this->fd, POLLIN, 0};
+    return ::poll(&pfd, 1, timeout) > 0;
+}
+
+int runWatch(
+    ParseCache& parseCache,
+    const std::vector<std::string>& otherPaths,
+    std::function<void()> build,
+    std::ostream& errors
+) {
+    int fd = inotify_init1(IN_CLOEXEC);
+    if (fd < 0) {
+        errors << std::format("failed to watch files: {}\n", std::strerror(errno));
+        return 1;
+    }
+
+    Watcher watcher{fd};
+
+    for (;;) {
+        build();
+        auto paths = parseCache.getParsedPaths();
+        paths.insert(paths.end(), otherPaths.begin(), otherPaths.end());
+        watcher.update(paths);
+
+        bool changed = false;
+        while (!changed) {
+            watcher.wait(-1);
+            changed = watcher.readEvents();
+        }
+
+        while (watcher.wait(settleMilliseconds)) {
+            watcher.readEvents();
+        }
+
+        parseCache.refresh();
+    }
+}
+
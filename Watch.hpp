@@ -0,0 +1,22 @@
+#ifndef WATCH_HPP
+#define WATCH_HPP
+
+#include "ParseCache.hpp"
+#include <functional>
+#include <iostream>
+#include <string>
+#include <vector>
+
+// Calls `build` and then again each time one of the files in `parseCache`,
+// or one of `otherPaths` such as imported symbol databases, changes.
+// Changed files are evicted from the cache before rebuilding so that only
+// they are parsed again.
+int runWatch(
+    ParseCache& parseCache,
+    const std::vector<std::string>& otherPaths,
+    std::function<void()> build,
+    std::ostream& errors
+);
+
+#endif
+
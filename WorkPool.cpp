@@ -0,0 +1,74 @@
+#include "WorkPool.hpp"
+#include <deque>
+#include <mutex>
+#include <optional>
+#include <thread>
+
+class WorkQueue {
+public:
+    std::mutex mutex;
+    std::deque<std::function<void()>> tasks;
+
+    std::optional<std::function<void()>> take(bool steal);
+};
+
+std::optional<std::function<void()>> WorkQueue::take(bool steal) {
+    std::scoped_lock lock{this->mutex};
+    if (this->tasks.empty()) {
+        return std::nullopt;
+    }
+
+    std::function<void()> task;
+    if (steal) {
+        task = std::move(this->tasks.back());
+        this->tasks.pop_back();
+    } else {
+        task = std::move(this->tasks.front());
+        this->tasks.pop_front();
+    }
+    return task;
+}
+
+void runParallel(std::vector<std::function<void()>> tasks, unsigned threads) {
+    if (tasks.empty()) {
+        return;
+    }
+    if (threads == 0) {
+        threads = 1;
+    }
+    if (threads > tasks.size()) {
+        threads = tasks.size();
+    }
+
+    std::vector<WorkQueue> queues(threads);
+    for (std::size_t i = 0; i < tasks.size(); ++i) {
+        queues[i % threads].tasks.push_back(std::move(tasks[i]));
+    }
+
+    // Tasks are never added once started, so a worker finding every queue
+    // empty is done.
+    auto work = [&queues, threads](unsigned self) {
+        for (;;) {
+            auto task = queues[self].take(false);
+            for (unsigned i = 1; !task && i < threads; ++i) {
+                task = queues[(self + i) % threads].take(true);
+            }
+
+            if (!task) {
+                return;
+            }
+            (*task)();
+        }
+    };
+
+    std::vector<std::thread> workers{};
+    for (unsigned i = 1; i < threads; ++i) {
+        workers.emplace_back(work, i);
+    }
+    work(0);
+
+    for (auto& worker : workers) {
+        worker.join();
+    }
+}
+
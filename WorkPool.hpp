@@ -0,0 +1,13 @@
+#ifndef WORKPOOL_HPP
+#define WORKPOOL_HPP
+
+#include <functional>
+#include <vector>
+
+// Runs `tasks` on `threads` worker threads and returns once all have
+// finished. Each worker starts with its own share of the tasks and steals
+// from the others once it runs out.
+void runParallel(std::vector<std::function<void()>> tasks, unsigned threads);
+
+#endif
+
@@ -0,0 +1,336 @@
+#include "../Assembler.hpp"
+#include "../Context.hpp"
+#include "../Expression.hpp"
+#include "../FileProvider.hpp"
+#include "../InstructionStatement.hpp"
+#include "../ParseCache.hpp"
+#include "../Statement.hpp"
+#include <SpdrFirmware/InstructionSet.hpp>
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <format>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+// Microbenchmarks of the assembler's hot paths on fixed synthetic inputs.
+// Each benchmark is timed over several samples of enough operations to
+// take about `sampleTime`, and the median and fastest sample are reported
+// per operation. Arguments select benchmarks whose name contains one.
+
+using Clock = std::chrono::steady_clock;
+
+const auto sampleTime = std::chrono::milliseconds{50};
+const int samples = 11;
+
+class Benchmark {
+public:
+    std::string name;
+
+    // Performs `iterations` operations.
+    std::function<void(std::size_t iterations)> run;
+};
+
+// Keeps the compiler from discarding results.
+volatile std::int64_t sink = 0;
+
+double timeIterations(const Benchmark& benchmark, std::size_t iterations) {
+    auto start = Clock::now();
+    benchmark.run(iterations);
+    std::chrono::duration<double, std::nano> elapsed = Clock::now() - start;
+    return elapsed.count();
+}
+
+void runBenchmark(const Benchmark& benchmark, std::ostream& stream) {
+    // Double the operations per sample until a sample is long enough.
+    std::size_t iterations = 1;
+    while (timeIterations(benchmark, iterations)
+        < std::chrono::duration<double, std::nano>{sampleTime}.count()
+    ) {
+        iterations *= 2;
+    }
+
+    std::vector<double> times{};
+    for (int i = 0; i < samples; ++i) {
+        times.push_back(timeIterations(benchmark, iterations) / iterations);
+    }
+    std::sort(times.begin(), times.end());
+
+    stream << std::format(
+        "{:<28} {:>12.1f} ns/op (min {:.1f}, {} ops/sample)\n",
+        benchmark.name,
+        times[times.size() / 2],
+        times.front(),
+        iterations
+    );
+}
+
+
+// An assembler over in-memory sources.
+class Fixture {
+public:
+    const InstructionSet instructionSet;
+    MemoryFileProvider files;
+    ParseCache parseCache;
+    Assembler assembler;
+
+    Fixture();
+
+    Block* parse(const std::string& fileName, std::string source);
+};
+
+Fixture::Fixture()
+:   instructionSet{},
+    files{},
+    parseCache{{}, &this->files},
+    assembler{SectionMode::ROM, this->instructionSet, this->parseCache, {}} {}
+
+Block* Fixture::parse(const std::string& fileName, std::string source) {
+    this->files.setFile(fileName, std::move(source));
+
+    Context context{&this->assembler};
+    auto parsed = this->parseCache.getParsedFile(context, fileName);
+    if (!parsed || context.hasErrors()) {
+        context.displayErrors(std::cerr);
+        std::exit(1);
+    }
+    return parsed->block;
+}
+
+std::string getProgramSource(int routines) {
+    std::stringstream ss{};
+    for (int i = 0; i < routines; ++i) {
+        ss << "routine" << i << ":\n"
+            << "    value" << i << " = " << i << " * 3 + (" << i << " >> 1)\n"
+            << ".loop:\n"
+            << "    jmp .loop\n"
+            << "    data value" << i << " & 0xff, word value" << i << ", \"text\"\n"
+            << "    nop\n";
+    }
+    return ss.str();
+}
+
+std::string getMacroSource(int expansions) {
+    std::stringstream ss{};
+    ss << "macro bench_put value\n"
+        << "    data value & 0xff, (value >> 8) & 0xff\n"
+        << "    data value ^ 0x55\n"
+        << "endmacro\n";
+    for (int i = 0; i < expansions; ++i) {
+        ss << "bench_put " << i << '\n';
+    }
+    return ss.str();
+}
+
+std::string getRepeatSource(int count) {
+    return std::format(
+        "repeat i, {}\n"
+        "    data i & 0xff, (i * 7) & 0xff\n"
+        "end\n"
+        "repeat {}\n"
+        "    data 1, 2, 3\n"
+        "end\n",
+        count,
+        count
+    );
+}
+
+// Assembles `fileName` again each operation, with its parse cached.
+Benchmark getAssemblyBenchmark(
+    const std::string& name,
+    const std::string& fileName,
+    std::string source
+) {
+    auto fixture = std::make_shared<Fixture>();
+    fixture->parse(fileName, std::move(source));
+
+    return {name, [fixture, fileName](std::size_t iterations) {
+        for (std::size_t i = 0; i < iterations; ++i) {
+            std::stringstream output{};
+            if (!fixture->assembler.run(fileName, output, std::cerr)) {
+                std::exit(1);
+            }
+            sink = sink + output.str().size();
+        }
+    }};
+}
+
+std::vector<Benchmark> getBenchmarks() {
+    std::vector<Benchmark> benchmarks{};
+
+    // Scanning and parsing a 3000 line file.
+    {
+        auto fixture = std::make_shared<Fixture>();
+        fixture->files.setFile("parse.asm", getProgramSource(500));
+
+        benchmarks.push_back({"parse", [fixture](std::size_t iterations) {
+            for (std::size_t i = 0; i < iterations; ++i) {
+                ParseCache parseCache{{}, &fixture->files};
+                Context context{&fixture->assembler};
+                auto parsed = parseCache.getParsedFile(context, "parse.asm");
+                sink = sink + parsed->block->statements.size();
+            }
+        }});
+    }
+
+    // Qualifying a local name and looking symbols up.
+    {
+        auto fixture = std::make_shared<Fixture>();
+        auto context = std::make_shared<Context>(&fixture->assembler);
+
+        std::vector<Identifier> identifiers{};
+        for (int i = 0; i < 4096; ++i) {
+            identifiers.push_back(Identifier{std::vector<std::string>{
+                std::format("routine{}", i),
+                "loop"
+            }});
+            fixture->assembler.assignSymbol(
+                *context,
+                Location{},
+                identifiers.back(),
+                i
+            );
+        }
+        context->setScope(Identifier{std::vector<std::string>{"routine17", "inner"}});
+
+        benchmarks.push_back({"qualify", [fixture, context](std::size_t iterations) {
+            const UnqualifiedIdentifier local{std::vector<std::string>{"loop"}, 1};
+            for (std::size_t i = 0; i < iterations; ++i) {
+                auto qualified = context->qualify(Location{}, local);
+                sink = sink + qualified->value.size();
+            }
+        }});
+
+        benchmarks.push_back({"symbol lookup", [fixture, identifiers](std::size_t iterations) {
+            for (std::size_t i = 0; i < iterations; ++i) {
+                auto value = fixture->assembler.resolveSymbol(
+                    identifiers[(i * 2654435761u) % identifiers.size()]
+                );
+                sink = sink + *value;
+            }
+        }});
+    }
+
+    // Evaluating an expression with symbols, operators and a call.
+    {
+        auto fixture = std::make_shared<Fixture>();
+        auto block = fixture->parse(
+            "expression.asm",
+            "a = 0x1234\n"
+            "b = 77\n"
+            "c = 0x8000\n"
+            "x = (a + b * 3 - (c >> 2)) & 0xff | min(a, b, 7) ^ (c / 16 % 5)\n"
+        );
+        auto context = std::make_shared<Context>(&fixture->assembler);
+        if (!block->assemble(*context)) {
+            std::exit(1);
+        }
+        auto statement = dynamic_cast<const SymbolStatement*>(block->statements.back());
+
+        benchmarks.push_back({"expression", [fixture, context, statement](std::size_t iterations) {
+            for (std::size_t i = 0; i < iterations; ++i) {
+                sink = sink + *statement->expr->evaluate(*context);
+            }
+        }});
+    }
+
+    // Writing to the code section, starting again before it fills.
+    {
+        auto fixture = std::make_shared<Fixture>();
+        auto context = std::make_shared<Context>(&fixture->assembler);
+        auto value = std::make_shared<LiteralExpression>(Location{}, 0x1234);
+        const std::size_t perSection = 0x1000;
+
+        benchmarks.push_back({"writeInteger", [fixture, context, value](std::size_t iterations) {
+            for (std::size_t i = 0; i < iterations; ++i) {
+                if (i % perSection == 0) {
+                    context->sections["code"] = Section{&fixture->assembler.sections["code"]};
+                }
+                context->getSection().writeInteger(*context, value.get(), 2);
+            }
+        }});
+
+        benchmarks.push_back({"writeBytes", [fixture, context](std::size_t iterations) {
+            const std::vector<char> bytes(4, 'x');
+            for (std::size_t i = 0; i < iterations; ++i) {
+                if (i % perSection == 0) {
+                    context->sections["code"] = Section{&fixture->assembler.sections["code"]};
+                }
+                context->getSection().writeBytes(*context, Location{}, bytes);
+            }
+        }});
+    }
+
+    // Looking instructions up, including a name which is not one.
+    {
+        auto fixture = std::make_shared<Fixture>();
+        auto block = fixture->parse(
+            "instructions.asm",
+            "nop\n"
+            "jmp 0x1234\n"
+            "phc\n"
+            "bench_miss 1\n"
+        );
+
+        std::vector<Instruction> instructions{};
+        for (const auto* statement : block->statements) {
+            instructions.push_back(
+                dynamic_cast<const InstructionStatement*>(statement)->instruction
+            );
+        }
+
+        benchmarks.push_back({"instruction lookup", [fixture, instructions](std::size_t iterations) {
+            for (std::size_t i = 0; i < iterations; ++i) {
+                auto micros = fixture->instructionSet.getInstruction(
+                    instructions[i % instructions.size()]
+                );
+                sink = sink + (micros != nullptr);
+            }
+        }});
+    }
+
+    benchmarks.push_back(getAssemblyBenchmark(
+        "macro expansion (x500)",
+        "macro.asm",
+        getMacroSource(500)
+    ));
+
+    benchmarks.push_back(getAssemblyBenchmark(
+        "repeat expansion (x2000)",
+        "repeat.asm",
+        getRepeatSource(2000)
+    ));
+
+    benchmarks.push_back(getAssemblyBenchmark(
+        "assemble (500 routines)",
+        "program.asm",
+        getProgramSource(500)
+    ));
+
+    return benchmarks;
+}
+
+int main(int argc, char** argv) {
+    std::vector<std::string> filters{argv + 1, argv + argc};
+
+    for (const auto& benchmark : getBenchmarks()) {
+        bool selected = filters.empty() || std::any_of(
+            filters.begin(),
+            filters.end(),
+            [&](const std::string& filter) {
+                return benchmark.name.find(filter) != std::string::npos;
+            }
+        );
+
+        if (selected) {
+            runBenchmark(benchmark, std::cout);
+        }
+    }
+    return 0;
+}
+
@@ -0,0 +1,424 @@
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <format>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <optional>
+#include <sstream>
+#include <string>
+#include <vector>
+
+// Checks that assembly time and peak memory grow no faster than each kind
+// of input allows. Every scenario generates sources of a growing size n,
+// runs the assembler on them, and fits the growth of what each size adds
+// to an empty program as n^k. The check fails if k exceeds the scenario's bound.
+//
+//   aspdr-scaling ASPDR [SCENARIO...]          run the checks
+//   aspdr-scaling --generate DIR SCENARIO N    only write the sources
+
+using Clock = std::chrono::steady_clock;
+
+// Each size is double the last.
+const int sizeSteps = 4;
+
+// Runs per size; the fastest is used.
+const int runs = 3;
+
+// Slack for noise and logarithmic factors above the declared exponent.
+const double tolerance = 0.3;
+
+// Smaller costs are too noisy to compare and are left out of the fit.
+const double minimumSeconds = 0.01;
+const double minimumKilobytes = 256;
+
+// Files to write, by name relative to the corpus directory. The first is
+// the one to assemble.
+using Corpus = std::vector<std::pair<std::string, std::string>>;
+
+class Scenario {
+public:
+    std::string name;
+    std::string description;
+    int baseSize;
+
+    // Declared growth exponents.
+    double timeBound;
+    double memoryBound;
+
+    std::function<Corpus(int n)> generate;
+};
+
+Corpus generateLabels(int n) {
+    std::stringstream ss{};
+    for (int i = 0; i < n; ++i) {
+        ss << "label" << i << ":\n"
+            << "    data label" << i << " & 0xff, label" << i / 2 << " >> 8\n";
+    }
+    return {{"main.asm", ss.str()}};
+}
+
+Corpus generateForwardReferences(int n) {
+    std::stringstream ss{};
+    for (int i = 0; i < n; ++i) {
+        ss << "    dataw target" << i << '\n';
+    }
+    for (int i = 0; i < n; ++i) {
+        ss << "target" << i << ":\n"
+            << "    data " << i % 256 << '\n';
+    }
+    return {{"main.asm", ss.str()}};
+}
+
+Corpus generateSymbols(int n) {
+    std::stringstream ss{};
+    ss << "symbol0 = 1\n";
+    for (int i = 1; i < n; ++i) {
+        ss << "symbol" << i << " = (symbol" << i - 1 << " * 3 + " << i << ") & 0xffff\n";
+    }
+    ss << "    dataw symbol" << n - 1 << '\n';
+    return {{"main.asm", ss.str()}};
+}
+
+Corpus generateScopes(int n) {
+    // Chains of local labels up to 16 deep, each referring to its parent.
+    const int maxDepth = 16;
+
+    std::stringstream ss{};
+    for (int i = 0; i < n; ++i) {
+        int depth = i % maxDepth;
+        std::string dots(depth, '.');
+        if (depth == 0) {
+            ss << "scope" << i << ":\n";
+        } else {
+            ss << dots << "level" << depth << ":\n"
+                << "    dataw " << dots << "level" << depth << '\n';
+        }
+    }
+    return {{"main.asm", ss.str()}};
+}
+
+Corpus generateNesting(int n) {
+    // Blocks nested n deep, alternating repeats and conditionals.
+    std::stringstream ss{};
+    for (int i = 0; i < n; ++i) {
+        ss << (i % 2 == 0 ? "repeat 1\n" : "if 1\n");
+        ss << "    data " << i % 256 << '\n';
+    }
+    for (int i = 0; i < n; ++i) {
+        ss << "end\n";
+    }
+    return {{"main.asm", ss.str()}};
+}
+
+Corpus generateRepeats(int n) {
+    std::stringstream ss{};
+    ss << "repeat i, " << n << '\n'
+        << "    data i & 0xff\n"
+        << "    repeat j, 4\n"
+        << "        data (i + j) & 0xff\n"
+        << "    end\n"
+        << "end\n";
+    return {{"main.asm", ss.str()}};
+}
+
+Corpus generateMacros(int n) {
+    std::stringstream ss{};
+    for (int i = 0; i < n; ++i) {
+        ss << "macro expand" << i << " value\n"
+            << "    data value & 0xff, " << i % 256 << '\n'
+            << "endmacro\n";
+    }
+    for (int i = 0; i < n; ++i) {
+        ss << "expand" << i << ' ' << i << '\n'
+            << "expand" << (i * 7) % n << ' ' << i << '\n';
+    }
+    return {{"main.asm", ss.str()}};
+}
+
+Corpus generateIncludes(int n) {
+    Corpus corpus{{"main.asm", ""}};
+
+    std::stringstream main{};
+    for (int i = 0; i < n; ++i) {
+        std::string name = std::format("include{}.asm", i);
+        main << "include \"" << name << "\"\n";
+        corpus.push_back({name, std::format(
+            "file{}:\n"
+            "    data file{} & 0xff, {}\n",
+            i, i, i % 256
+        )});
+    }
+    corpus[0].second = main.str();
+    return corpus;
+}
+
+// Sizes are chosen so that the largest output still fits the code section.
+std::vector<Scenario> getScenarios() {
+    return {
+        {"labels", "n labels referring to earlier ones", 1000, 1, 1, generateLabels},
+        {"forward", "n forward references", 1000, 1, 1, generateForwardReferences},
+        {"symbols", "a chain of n symbols", 4000, 1, 1, generateSymbols},
+        {"scopes", "n labels in local chains up to 16 deep", 1000, 1, 1, generateScopes},
+        {"nesting", "blocks nested n deep", 125, 1, 1, generateNesting},
+        {"repeats", "nested repeats of n iterations", 500, 1, 1, generateRepeats},
+        {"macros", "n macros invoked twice each", 500, 1, 1, generateMacros},
+        {"includes", "n included files", 250, 1, 1, generateIncludes},
+    };
+}
+
+
+bool writeCorpus(const std::filesystem::path& directory, const Corpus& corpus) {
+    std::filesystem::create_directories(directory);
+    for (const auto& file : corpus) {
+        std::ofstream stream{directory / file.first};
+        stream << file.second;
+        if (!stream) {
+            std::cerr << "failed to write '" << (directory / file.first).string() << "'\n";
+            return false;
+        }
+    }
+    return true;
+}
+
+class Measurement {
+public:
+    double seconds;
+    long peakKilobytes;
+};
+
+// Runs the assembler on `fileName` in `directory`, returning nothing if it
+// could not be run or failed.
+std::optional<Measurement> measure(
+    const std::string& aspdr,
+    const std::filesystem::path& directory,
+    const std::string& fileName
+) {
+    auto start = Clock::now();
+
+    pid_t pid = ::fork();
+    if (pid < 0) {
+        return std::nullopt;
+    }
+    if (pid == 0) {
+        int null = ::open("/dev/null", O_WRONLY);
+        ::dup2(null, STDOUT_FILENO);
+        if (::chdir(directory.c_str()) < 0) {
+            ::_exit(127);
+        }
+        ::execl(aspdr.c_str(), aspdr.c_str(), fileName.c_str(), "-o", "/dev/null", nullptr);
+        ::_exit(127);
+    }
+
+    int status;
+    rusage usage{};
+    if (::wait4(pid, &status, 0, &usage) < 0
+        || !WIFEXITED(status)
+        || WEXITSTATUS(status) != 0
+    ) {
+        return std::nullopt;
+    }
+
+    std::chrono::duration<double> elapsed = Clock::now() - start;
+    return Measurement{elapsed.count(), usage.ru_maxrss};
+}
+
+std::optional<Measurement> measureBest(
+    const std::string& aspdr,
+    const std::filesystem::path& directory,
+    const Corpus& corpus
+) {
+    if (!writeCorpus(directory, corpus)) {
+        return std::nullopt;
+    }
+
+    std::optional<Measurement> best{};
+    for (int i = 0; i < runs; ++i) {
+        auto measurement = measure(aspdr, directory, corpus.front().first);
+        if (!measurement) {
+            return std::nullopt;
+        }
+        if (!best || measurement->seconds < best->seconds) {
+            best = Measurement{measurement->seconds, best ? best->peakKilobytes : 0};
+        }
+        best->peakKilobytes = std::max(best->peakKilobytes, measurement->peakKilobytes);
+    }
+    return best;
+}
+
+// Fits cost = c * n^k through the measurable costs by least squares on
+// their logarithms, returning k. Too few measurable costs fit as 0.
+double getExponent(
+    const std::vector<int>& sizes,
+    const std::vector<double>& costs,
+    double minimum
+) {
+    std::vector<std::pair<double, double>> points{};
+    for (std::size_t i = 0; i < sizes.size(); ++i) {
+        if (costs[i] >= minimum) {
+            points.push_back({std::log(sizes[i]), std::log(costs[i])});
+        }
+    }
+    if (points.size() < 2) {
+        return 0;
+    }
+
+    double meanX = 0;
+    double meanY = 0;
+    for (const auto& point : points) {
+        meanX += point.first / points.size();
+        meanY += point.second / points.size();
+    }
+
+    double covariance = 0;
+    double variance = 0;
+    for (const auto& point : points) {
+        covariance += (point.first - meanX) * (point.second - meanY);
+        variance += (point.first - meanX) * (point.first - meanX);
+    }
+    return covariance / variance;
+}
+
+bool runScenario(
+    const std::string& aspdr,
+    const std::filesystem::path& directory,
+    const Scenario& scenario,
+    const Measurement& baseline
+) {
+    std::cout << std::format("{} ({}):\n", scenario.name, scenario.description);
+
+    std::vector<int> sizes{};
+    std::vector<Measurement> measurements{};
+    int size = scenario.baseSize;
+    for (int step = 0; step < sizeSteps; ++step, size *= 2) {
+        auto corpusDirectory = directory / std::format("{}-{}", scenario.name, size);
+        auto measurement = measureBest(aspdr, corpusDirectory, scenario.generate(size));
+        std::filesystem::remove_all(corpusDirectory);
+
+        if (!measurement) {
+            std::cout << std::format("  n = {}: assembly failed\n", size);
+            return false;
+        }
+
+        // Only what the input adds to an empty program is compared.
+        measurement->seconds = std::max(measurement->seconds - baseline.seconds, 0.0);
+        measurement->peakKilobytes = std::max(
+            measurement->peakKilobytes - baseline.peakKilobytes,
+            0l
+        );
+        sizes.push_back(size);
+        measurements.push_back(*measurement);
+
+        std::cout << std::format(
+            "  n = {:>7}: {:>9.2f} ms {:>9} KiB\n",
+            size,
+            measurement->seconds * 1000,
+            measurement->peakKilobytes
+        );
+    }
+
+    std::vector<double> times{};
+    std::vector<double> memory{};
+    for (const auto& measurement : measurements) {
+        times.push_back(measurement.seconds);
+        memory.push_back(measurement.peakKilobytes);
+    }
+    double timeExponent = getExponent(sizes, times, minimumSeconds);
+    double memoryExponent = getExponent(sizes, memory, minimumKilobytes);
+
+    bool timeOk = timeExponent <= scenario.timeBound + tolerance;
+    bool memoryOk = memoryExponent <= scenario.memoryBound + tolerance;
+    std::cout << std::format(
+        "  time n^{:.2f} (bound n^{}) {}, memory n^{:.2f} (bound n^{}) {}\n",
+        timeExponent,
+        scenario.timeBound,
+        timeOk ? "ok" : "FAILED",
+        memoryExponent,
+        scenario.memoryBound,
+        memoryOk ? "ok" : "FAILED"
+    );
+    return timeOk && memoryOk;
+}
+
+int main(int argc, char** argv) {
+    std::vector<std::string> arguments{argv + 1, argv + argc};
+    auto scenarios = getScenarios();
+
+    auto findScenario = [&](const std::string& name) -> const Scenario* {
+        for (const auto& scenario : scenarios) {
+            if (scenario.name == name) {
+                return &scenario;
+            }
+        }
+        std::cerr << "unknown scenario '" << name << "'\n";
+        return nullptr;
+    };
+
+    if (!arguments.empty() && arguments[0] == "--generate") {
+        if (arguments.size() != 4) {
+            std::cerr << "usage: aspdr-scaling --generate DIR SCENARIO N\n";
+            return 2;
+        }
+
+        const Scenario* scenario = findScenario(arguments[2]);
+        if (!scenario) {
+            return 2;
+        }
+        return writeCorpus(arguments[1], scenario->generate(std::stoi(arguments[3])))
+            ? 0 : 1;
+    }
+
+    if (arguments.empty()) {
+        std::cerr << "usage: aspdr-scaling ASPDR [SCENARIO...]\n";
+        for (const auto& scenario : scenarios) {
+            std::cerr << "  " << scenario.name << ": " << scenario.description << '\n';
+        }
+        return 2;
+    }
+
+    std::string aspdr = std::filesystem::absolute(arguments[0]).string();
+    std::vector<const Scenario*> selected{};
+    for (std::size_t i = 1; i < arguments.size(); ++i) {
+        const Scenario* scenario = findScenario(arguments[i]);
+        if (!scenario) {
+            return 2;
+        }
+        selected.push_back(scenario);
+    }
+    if (selected.empty()) {
+        for (const auto& scenario : scenarios) {
+            selected.push_back(&scenario);
+        }
+    }
+
+    char directoryTemplate[] = "/tmp/aspdr-scaling-XXXXXX";
+    if (!::mkdtemp(directoryTemplate)) {
+        std::cerr << "failed to create a directory: " << std::strerror(errno) << '\n';
+        return 1;
+    }
+    std::filesystem::path directory{directoryTemplate};
+
+    auto baseline = measureBest(aspdr, directory / "empty", {{"main.asm", ""}});
+    if (!baseline) {
+        std::cerr << "failed to run '" << aspdr << "'\n";
+        std::filesystem::remove_all(directory);
+        return 1;
+    }
+
+    bool success = true;
+    for (const auto* scenario : selected) {
+        success = runScenario(aspdr, directory, *scenario, *baseline) && success;
+    }
+
+    std::filesystem::remove_all(directory);
+    return success ? 0 : 1;
+}
+
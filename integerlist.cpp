@@ -0,0 +1,120 @@
+#include "integerlist.hpp"
+#include <bit>
+#include <cstring>
+#include <string>
+
+const std::uint64_t ones = 0x0101010101010101;
+
+// Returns the number of leading decimal digits in the 8 bytes at `str`.
+int countDigits(const char* str) {
+    std::uint64_t value;
+    std::memcpy(&value, str, sizeof(value));
+
+    // A byte is a digit if its high nibble is 3 and adding 6 does not
+    // carry out of its low nibble.
+    std::uint64_t high = (value & (ones * 0xf0)) ^ (ones * 0x30);
+    std::uint64_t low = ((value + ones * 0x06) & (ones * 0xf0)) ^ (ones * 0x30);
+    std::uint64_t nonDigits = high | low;
+
+    if (nonDigits == 0) {
+        return 8;
+    }
+    return std::countr_zero(nonDigits) / 8;
+}
+
+// Converts `count` (at most 8) decimal digits at `str` at once.
+std::uint64_t convertDigits(const char* str, int count) {
+    if (count == 0) {
+        return 0;
+    }
+
+    std::uint64_t value;
+    std::memcpy(&value, str, sizeof(value));
+
+    // Shifting in zero bytes from the bottom adds leading zeros.
+    value = (value << (8 * (8 - count))) & (ones * 0x0f);
+    value = (value * 10 + (value >> 8)) & 0x00ff00ff00ff00ff;
+    value = (value * 100 + (value >> 16)) & 0x0000ffff0000ffff;
+    value = (value * 10000 + (value >> 32)) & 0x00000000ffffffff;
+    return value;
+}
+
+std::uint64_t processDecimal(const char*& str) {
+    std::uint64_t value = 0;
+    for (;;) {
+        int count = countDigits(str);
+        for (int i = 0; i < count; ++i) {
+            value *= 10;
+        }
+        value += convertDigits(str, count);
+        str += count;
+
+        if (count < 8) {
+            return value;
+        }
+    }
+}
+
+std::uint64_t processDecimalScalar(const char*& str) {
+    std::uint64_t value = 0;
+    while (*str >= '0' && *str <= '9') {
+        value = value * 10 + (*str++ - '0');
+    }
+    return value;
+}
+
+std::uint64_t processRadix(const char*& str, int radix) {
+    std::uint64_t value = 0;
+    for (;;) {
+        char c = *str;
+        int digit;
+        if (c >= '0' && c <= '9') {
+            digit = c - '0';
+        } else if (c >= 'a' && c <= 'f') {
+            digit = c - 'a' + 10;
+        } else if (c >= 'A' && c <= 'F') {
+            digit = c - 'A' + 10;
+        } else {
+            return value;
+        }
+
+        if (digit >= radix) {
+            return value;
+        }
+        value = value * radix + digit;
+        ++str;
+    }
+}
+
+std::vector<std::int64_t> processIntegerList(std::string_view str) {
+    // Padding lets the digit parser read whole words past the last literal.
+    std::string buffer{str};
+    buffer.append(sizeof(std::uint64_t), '\0');
+
+    std::vector<std::int64_t> values{};
+    values.reserve(str.size() / 2 + 1);
+
+    const char* current = buffer.c_str();
+    const char* end = current + str.size();
+    while (current < end) {
+        char c = *current;
+        if (c == ' ' || c == '\t' || c == ',') {
+            ++current;
+            continue;
+        }
+
+        if (c == '0' && (current[1] == 'x' || current[1] == 'X')) {
+            current += 2;
+            values.push_back(processRadix(current, 16));
+        } else if (c == '0' && (current[1] == 'b' || current[1] == 'B')) {
+            current += 2;
+            values.push_back(processRadix(current, 2));
+        } else if constexpr (std::endian::native == std::endian::little) {
+            values.push_back(processDecimal(current));
+        } else {
+            values.push_back(processDecimalScalar(current));
+        }
+    }
+    return values;
+}
+
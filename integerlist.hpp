@@ -0,0 +1,13 @@
+#ifndef INTEGERLIST_HPP
+#define INTEGERLIST_HPP
+
+#include <vector>
+#include <string_view>
+#include <cstdint>
+
+// Converts a comma separated list of decimal, hexadecimal and binary
+// literals as matched by the scanner.
+std::vector<std::int64_t> processIntegerList(std::string_view str);
+
+#endif
+
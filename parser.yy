@@ -88,12 +88,16 @@
     ENDMACRO "endmacro"
     VARIABLE "variable"
     PROVIDES "provides"
+    ASSERT_CYCLES "assert_cycles"
     IF "if"
     ELSE "else"
     ELSEIF "elseif"
     REPEAT "repeat"
     END "end"
     NAMESPACE "namespace"
+    TABLE "table"
+    TABLEW "tablew"
+    TABLE_SPLIT "table_split"
     ;
 
 %token A C D CD F SP
@@ -101,6 +105,7 @@
 %token <UnqualifiedIdentifier> UID "raw_unqualified_id"
 %token <std::string> IDENTIFIER "identifier" STRING "string";
 %token <std::int64_t> INTEGER "integer";
+%token <std::vector<std::int64_t>> INTEGER_LIST "integer list";
 
 %%
 
@@ -152,8 +157,11 @@ statement_endline
     | macro_statement
     | VARIABLE ident expression {$$ = new VariableStatement(@$, $2, $3);}
     | "provides" STRING {$$ = new ProvidesStatement(@$, $2);}
+    | "assert_cycles" expression "," expression "," expression
+        {$$ = new CycleBudgetStatement{@$, $2, $4, $6};}
     | conditional_assembly
     | repeat_block
+    | table
     ;
 
 %nterm <Statement*> conditional_assembly;
@@ -178,6 +186,21 @@ repeat_block
         {$$ = new RepeatStatement{@$, $2, $4};}
     ;
 
+%nterm <Statement*> table;
+table
+    : table_type IDENTIFIER "," expression "," expression
+        {$$ = new TableStatement{@$, $1, $2, new LiteralExpression{@4, 0}, $4, $6};}
+    | table_type IDENTIFIER "," expression "," expression "," expression
+        {$$ = new TableStatement{@$, $1, $2, $4, $6, $8};}
+    ;
+
+%nterm <TableStatement::Type> table_type;
+table_type
+    : "table" {$$ = TableStatement::Type::Byte;}
+    | "tablew" {$$ = TableStatement::Type::Word;}
+    | "table_split" {$$ = TableStatement::Type::Split;}
+    ;
+
 %nterm <Statement*> macro_statement;
 macro_statement
     : "macro" IDENTIFIER parameter_list newline statements "endmacro"
@@ -189,7 +212,10 @@ macro_statement
 %nterm <std::vector<DataElement*>> data_element_list;
 data_element_list
     : data_element {$$ = {$1};}
+    | INTEGER_LIST {$$ = {new IntegerListElement(@$, $1)};}
     | data_element_list "," data_element {$$ = $1; $$.push_back($3);}
+    | data_element_list "," INTEGER_LIST
+        {$$ = $1; $$.push_back(new IntegerListElement(@3, $3));}
     ;
 
 %nterm <DataElement*> data_element;
@@ -311,11 +337,18 @@ expression
     | expression "!=" expression {$$ = new BinaryExpression{@$, Binary::NotEqual, $1, $3};}
     | "(" expression ")" {$$ = $2;}
     | ident {$$ = new SymbolicExpression{@$, $1};}
+    | IDENTIFIER "(" expression_list ")" {$$ = new CallExpression{@$, $1, $3};}
+    ;
+
+%nterm <std::vector<Expression*>> expression_list;
+expression_list
+    : expression {$$ = {$1};}
+    | expression_list "," expression {$$ = std::move($1); $$.push_back($3);}
     ;
 
 %%
 
 void yy::parser::error(const location_type& loc, const std::string& message) {
-    std::clog << Error{Error::Level::Fatal, loc, message};
+    driver.errors.push_back(Error{Error::Level::Syntax, loc, message});
 }
 